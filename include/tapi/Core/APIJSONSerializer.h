@@ -18,6 +18,7 @@
 #include "llvm/Support/JSON.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/TargetParser/Triple.h"
+#include <functional>
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
@@ -38,8 +39,19 @@ public:
 
   llvm::json::Object getJSONObject() const;
 
+  // Write the API as a JSON object into the stream. The output is the same as
+  // the one from getJSONObject(), without building the JSON object in memory.
+  void serialize(llvm::json::OStream &os) const;
+
   void serialize(raw_ostream &os) const;
 
+  // Content hash written with the API in an SDKDB. serialize() writes it as
+  // the last key and calls the function only then, so the hash can be taken
+  // from the output written before it.
+  void setContentHash(std::function<uint64_t()> hash) {
+    contentHash = std::move(hash);
+  }
+
   // static method to parse JSON into API.
   static llvm::Expected<API> parse(StringRef json);
   static llvm::Expected<API> parse(llvm::json::Object *root,
@@ -47,8 +59,11 @@ public:
                                    llvm::Triple *triple = nullptr);
 
 private:
+  void serializeObject(llvm::json::OStream &os, bool withVersion) const;
+
   const API &api;
   APIJSONOption options;
+  std::function<uint64_t()> contentHash;
 };
 
 class APIJSONError : public llvm::ErrorInfo<llvm::json::ParseError> {
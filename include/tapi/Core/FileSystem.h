@@ -60,13 +60,14 @@ class PathMaskingOverlayFileSystem : public MaskingOverlayFileSystem {
 public:
   PathMaskingOverlayFileSystem(IntrusiveRefCntPtr<FileSystem> base);
 
-  void addExtraMaskingDirectory(StringRef path) {
-    extraMaskingPath.emplace_back(path.str());
-  }
+  void addExtraMaskingDirectory(StringRef path);
 
 private:
   bool pathMasked(const Twine &path) const override;
+  bool isMaskedByPrefix(StringRef path) const;
 
+  /// Sorted masking paths. No path is a prefix of another one, so a lookup
+  /// only needs to check a single candidate.
   std::vector<std::string> extraMaskingPath;
 };
 
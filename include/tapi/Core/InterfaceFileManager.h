@@ -28,6 +28,8 @@ public:
   InterfaceFileManager(FileManager &fm, bool isVolatile);
   Expected<APIs &> readFile(const std::string &path,
                             ReadFlags flags = ReadFlags::Symbols);
+  /// Write the interface file unless an identical one already exists. Safe to
+  /// call from multiple threads for different paths.
   Error writeFile(const std::string &path, const InterfaceFile *file,
                   FileType fileType) const;
 
@@ -43,8 +45,7 @@ private:
     ReplaceFile,
   };
 
-  WriteAction shouldWrite(const std::string &path, const InterfaceFile *file,
-                          FileType fileType) const;
+  WriteAction shouldWrite(const std::string &path, StringRef contents) const;
 };
 
 TAPI_NAMESPACE_INTERNAL_END
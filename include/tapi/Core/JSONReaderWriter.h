@@ -23,17 +23,17 @@ TAPI_NAMESPACE_INTERNAL_BEGIN
 class JSONReader final : public Reader {
 public:
   JSONReader() : Reader(JSON) {}
-  bool canRead(file_magic magic, MemoryBufferRef memBufferRef,
+  bool canRead(const FileFormat &format, MemoryBufferRef memBufferRef,
                FileType types) const override;
 
   Expected<APIs> readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                           ReadFlags readFlags,
                           ArchitectureSet arches) const override;
 
-  Expected<FileType> getFileType(file_magic magic,
+  Expected<FileType> getFileType(const FileFormat &format,
                                  MemoryBufferRef bufferRef) const override {
-    return canRead(magic, bufferRef, FileType::All) ? FileType::TBD_V5
-                                                    : FileType::Invalid;
+    return canRead(format, bufferRef, FileType::All) ? FileType::TBD_V5
+                                                     : FileType::Invalid;
   }
   static bool classof(const Reader *reader) {
     return reader->getKind() == JSON;
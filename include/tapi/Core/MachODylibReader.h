@@ -28,9 +28,9 @@ TAPI_NAMESPACE_INTERNAL_BEGIN
 class MachODylibReader final : public Reader {
 public:
   MachODylibReader() : Reader(Binary) {}
-  bool canRead(file_magic magic, MemoryBufferRef bufferRef,
+  bool canRead(const FileFormat &format, MemoryBufferRef bufferRef,
                FileType types) const override;
-  Expected<FileType> getFileType(file_magic magic,
+  Expected<FileType> getFileType(const FileFormat &format,
                                  MemoryBufferRef bufferRef) const override;
   Expected<APIs> readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                           ReadFlags readFlags,
@@ -15,6 +15,7 @@
 #define TAPI_BINARY_MACHO_READER_H
 
 #include "tapi/Core/API.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/MachOUniversal.h"
@@ -30,11 +31,30 @@ struct MachOParseOption {
   bool parseSymbolTable = true;
   bool parseObjCMetadata = true;
   bool parseUndefined = true;
+  /// Number of threads used to read the slices of a universal binary. 0 uses
+  /// all available cores. Leave this at 1 when the caller already runs on a
+  /// worker pool.
+  unsigned numThreads = 1;
 };
 
 /// Returns macho file type. Unknown if the format is not supported.
 llvm::Expected<FileType> getMachOFileType(llvm::MemoryBufferRef bufferRef);
 
+/// Returns macho file type for a buffer whose \p magic was already
+/// identified.
+llvm::Expected<FileType> getMachOFileType(llvm::file_magic magic,
+                                          llvm::MemoryBufferRef bufferRef);
+
+/// Returns macho file type from the file headers alone. \p header holds the
+/// start of a file of \p fileSize bytes. Data beyond the header, such as the
+/// headers of the slices of a universal binary, is requested through
+/// \p readAt, whose result only needs to stay valid until the next call.
+llvm::Expected<FileType> getMachOFileType(
+    StringRef header, uint64_t fileSize,
+    llvm::function_ref<llvm::Expected<StringRef>(uint64_t offset,
+                                                 uint64_t size)>
+        readAt);
+
 using MachOParseResult =
     std::vector<std::pair<Architecture, std::shared_ptr<API>>>;
 
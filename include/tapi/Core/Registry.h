@@ -40,6 +40,17 @@ enum class ReadFlags {
   All,
 };
 
+/// The format of a buffer. The registry detects it once per buffer and hands
+/// it to every reader, so the readers don't sniff the buffer again.
+struct FileFormat {
+  /// The file magic. Leading white space is skipped for text files.
+  file_magic magic = file_magic::unknown;
+  /// The version of a text-based stub file. Invalid for all other files.
+  FileType textFileType = FileType::Invalid;
+
+  static FileFormat detect(MemoryBufferRef bufferRef);
+};
+
 /// Abstract Reader class - all readers need to inherit from this class and
 /// implement the interface.
 class Reader {
@@ -53,9 +64,9 @@ public:
   ReaderKind getKind() const { return kind; }
   Reader(ReaderKind kind) : kind(kind) {}
   virtual ~Reader() = default;
-  virtual bool canRead(file_magic fileType, MemoryBufferRef bufferRef,
+  virtual bool canRead(const FileFormat &format, MemoryBufferRef bufferRef,
                        FileType types = FileType::All) const = 0;
-  virtual Expected<FileType> getFileType(file_magic magic,
+  virtual Expected<FileType> getFileType(const FileFormat &format,
                                          MemoryBufferRef bufferRef) const = 0;
   virtual Expected<APIs> readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                                   ReadFlags readFlags,
@@ -95,6 +106,10 @@ public:
                   FileType fileType, bool replaceFile = true) const;
   Error writeFile(raw_ostream &os, const InterfaceFile *file,
                   FileType fileType) const;
+  /// Write already serialized \p contents to \p path. With \p replaceFile the
+  /// contents are written to a temporary file first, which is then renamed.
+  static Error writeFileContents(const std::string &path, StringRef contents,
+                                 bool replaceFile = true);
 
   void add(std::unique_ptr<Reader> reader) {
     _readers.emplace_back(std::move(reader));
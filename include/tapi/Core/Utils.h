@@ -17,6 +17,7 @@
 #include "tapi/Core/LLVM.h"
 #include "tapi/Defines.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Process.h"
 #include "llvm/TextAPI/InterfaceFile.h"
@@ -59,6 +60,14 @@ inline bool inBnIEnvironment() {
   return false;
 }
 
+/// Invoke \p func for every index in [0, count) on a pool of up to
+/// \p numThreads workers (0 uses all available cores). The indices are handed
+/// out in increasing order, but may complete in any order, so callers store
+/// per-index results and merge them afterwards to stay deterministic. Runs
+/// inline when only a single worker is needed.
+void parallelForEachIndex(size_t count, unsigned numThreads,
+                          llvm::function_ref<void(size_t)> func);
+
 using APIs = llvm::SmallVector<std::shared_ptr<API>, 4>;
 std::unique_ptr<InterfaceFile> convertToInterfaceFile(const APIs &apis);
 
@@ -42,8 +42,8 @@ struct YAMLContext {
 class DocumentHandler {
 public:
   virtual ~DocumentHandler() = default;
-  virtual bool canRead(MemoryBufferRef memBufferRef, FileType types) const = 0;
-  virtual FileType getFileType(MemoryBufferRef bufferRef) const = 0;
+  virtual bool canRead(FileType textFileType, FileType types) const = 0;
+  virtual FileType getFileType(FileType textFileType) const = 0;
   virtual bool canWrite(const InterfaceFile *file, FileType fileType) const = 0;
 
   bool writeFile(raw_ostream &os, const InterfaceFile *file,
@@ -61,9 +61,9 @@ namespace stub {
 namespace v1 {
 
 class YAMLDocumentHandler : public DocumentHandler {
-  bool canRead(MemoryBufferRef memBufferRef,
+  bool canRead(FileType textFileType,
                FileType types = FileType::All) const override;
-  FileType getFileType(MemoryBufferRef memBufferRef) const override;
+  FileType getFileType(FileType textFileType) const override;
   bool canWrite(const InterfaceFile *file, FileType fileType) const override;
 };
 
@@ -74,9 +74,9 @@ namespace stub {
 namespace v2 {
 
 class YAMLDocumentHandler : public DocumentHandler {
-  bool canRead(MemoryBufferRef memBufferRef,
+  bool canRead(FileType textFileType,
                FileType types = FileType::All) const override;
-  FileType getFileType(MemoryBufferRef memBufferRef) const override;
+  FileType getFileType(FileType textFileType) const override;
   bool canWrite(const InterfaceFile *file, FileType fileType) const override;
 };
 
@@ -87,9 +87,9 @@ namespace stub {
 namespace v3 {
 
 class YAMLDocumentHandler : public DocumentHandler {
-  bool canRead(MemoryBufferRef memBufferRef,
+  bool canRead(FileType textFileType,
                FileType types = FileType::All) const override;
-  FileType getFileType(MemoryBufferRef memBufferRef) const override;
+  FileType getFileType(FileType textFileType) const override;
   bool canWrite(const InterfaceFile *file, FileType fileType) const override;
 };
 
@@ -100,9 +100,9 @@ namespace stub {
 namespace v4 {
 
 class YAMLDocumentHandler : public DocumentHandler {
-  bool canRead(MemoryBufferRef memBufferRef,
+  bool canRead(FileType textFileType,
                FileType types = FileType::All) const override;
-  FileType getFileType(MemoryBufferRef memBufferRef) const override;
+  FileType getFileType(FileType textFileType) const override;
   bool canWrite(const InterfaceFile *file, FileType fileType) const override;
 };
 
@@ -111,8 +111,8 @@ class YAMLDocumentHandler : public DocumentHandler {
 
 class YAMLBase {
 public:
-  bool canRead(MemoryBufferRef memBufferRef, FileType types) const;
-  FileType getFileType(MemoryBufferRef bufferRef) const;
+  bool canRead(FileType textFileType, FileType types) const;
+  FileType getFileType(FileType textFileType) const;
   bool canWrite(const InterfaceFile *file, FileType fileType) const;
   bool writeFile(raw_ostream &os, const InterfaceFile *file,
                  FileType fileType) const;
@@ -128,9 +128,9 @@ private:
 class YAMLReader final : public YAMLBase, public Reader {
 public:
   YAMLReader() : Reader(YAML) {}
-  bool canRead(file_magic magic, MemoryBufferRef memBufferRef,
+  bool canRead(const FileFormat &format, MemoryBufferRef memBufferRef,
                FileType types) const override;
-  Expected<FileType> getFileType(file_magic magic,
+  Expected<FileType> getFileType(const FileFormat &format,
                                  MemoryBufferRef bufferRef) const override;
   Expected<APIs> readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                           ReadFlags readFlags,
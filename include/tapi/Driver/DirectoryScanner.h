@@ -18,8 +18,13 @@
 #include "tapi/Core/Registry.h"
 #include "tapi/Defines.h"
 #include "tapi/Driver/Configuration.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include <memory>
+#include <string>
+#include <system_error>
 #include <vector>
 
 
@@ -54,6 +59,67 @@ private:
   Mode mode;
 };
 
+/// Caches directory listings, stat results and sniffed file types for the
+/// directory scanner. The cache can be shared between scanners, so a tree that
+/// is scanned in several modes is only read from the file system once.
+class DirectoryCache {
+public:
+  enum class EntryKind { File, Directory, Missing };
+
+  struct Entry {
+    std::string path;
+    EntryKind kind;
+    bool isSymlink;
+    /// Error the directory iterator reported for this entry. This usually
+    /// happens for broken symlinks.
+    std::error_code ec = {};
+  };
+
+  struct Listing {
+    std::vector<Entry> entries;
+    /// Error that stopped the listing and the entry it was reported for.
+    std::error_code ec;
+    std::string errorPath;
+  };
+
+  struct FileInfo {
+    /// Error from reading the file.
+    std::error_code ec;
+    /// Error from determining the file type.
+    std::string error;
+    FileType type = FileType::Invalid;
+    /// Bytes read to determine the file type.
+    uint64_t bytesRead = 0;
+  };
+
+  DirectoryCache(FileManager &fm);
+
+  /// Read the listings of the directories and all their sub-directories on
+  /// up to \p numThreads threads (0 means all cores). The file types of the
+  /// regular files are determined as well for every directory that
+  /// \p sniffFiles returns true for.
+  void prefetch(ArrayRef<std::string> directories,
+                llvm::function_ref<bool(StringRef)> sniffFiles,
+                unsigned numThreads);
+
+  const Listing &getListing(StringRef directory);
+  const FileInfo &getFileInfo(StringRef path);
+
+  /// Number of files whose type was determined and the bytes read for it.
+  uint64_t getNumFilesRead() const { return fileInfos.size(); }
+  uint64_t getNumBytesRead() const { return numBytesRead; }
+
+private:
+  Listing readListing(StringRef directory) const;
+  FileInfo readFileInfo(StringRef path) const;
+  const FileInfo &addFileInfo(StringRef path, FileInfo info);
+
+  FileManager &_fm;
+  llvm::StringMap<Listing> listings;
+  llvm::StringMap<FileInfo> fileInfos;
+  uint64_t numBytesRead = 0;
+};
+
 class DirectoryScanner {
 public:
   DirectoryScanner(FileManager &fm, DiagnosticsEngine &diag,
@@ -64,6 +130,10 @@ public:
   // Access scanner internal.
   void setMode(ScannerMode scanMode) { mode = scanMode; }
   void setSplitHeaderDir(bool splitHeader) { useSplitHeaderDir = splitHeader; }
+  void setNumThreads(unsigned threads) { numThreads = threads; }
+  void setDirectoryCache(DirectoryCache &directoryCache) {
+    cache = &directoryCache;
+  }
 
   // Get scanner output.
   std::vector<Framework> takeResult();
@@ -75,6 +145,8 @@ public:
 private:
   // Private helper functions.
   Expected<bool> isDynamicLibrary(StringRef path) const;
+  bool isLibraryDirectory(StringRef directory) const;
+  void prefetch(ArrayRef<std::string> directories) const;
 
   Framework &getOrCreateFramework(StringRef path,
                                   std::vector<Framework> &frameworks) const;
@@ -90,6 +162,7 @@ private:
                    StringRef basePath, StringRef parentPath = StringRef()) const;
   bool scanModules(Framework &framework, StringRef path) const;
   bool scanSwiftModules(Framework &framework, StringRef path) const;
+  bool scanSwiftModuleDirectory(SwiftModule &module, StringRef path) const;
   bool scanFrameworkVersionsDirectory(Framework &framework,
                                       StringRef path) const;
   bool scanLibraryDirectory(Framework &framework, StringRef path) const;
@@ -102,14 +175,16 @@ private:
                           const Framework &framework) const;
 
 private:
-  Registry _registry;
   FileManager &_fm;
   DiagnosticsEngine &diag;
   StringRef rootPath;
+  std::unique_ptr<DirectoryCache> ownedCache;
+  DirectoryCache *cache;
 
   ScannerMode mode;
   std::vector<Framework> frameworks;
   bool useSplitHeaderDir = false;
+  unsigned numThreads = 1;
 };
 
 TAPI_NAMESPACE_INTERNAL_END
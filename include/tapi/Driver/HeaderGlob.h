@@ -18,6 +18,9 @@
 #include "tapi/Core/LLVM.h"
 #include "tapi/Driver/Glob.h"
 #include "tapi/Defines.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Regex.h"
@@ -34,13 +37,47 @@ public:
   bool didMatch() { return foundMatch; }
   StringRef str() { return globString; }
 
+  /// The literal text before the first wildcard, which every match starts
+  /// with.
+  StringRef getLiteralPrefix() const {
+    return StringRef(globString).take_front(literalPrefixSize);
+  }
+
+  /// The literal text after the last wildcard, which every match ends with.
+  /// Like the regex, this skips the character that follows a run of '*'.
+  StringRef getLiteralSuffix() const {
+    return StringRef(globString).take_back(literalSuffixSize);
+  }
+
 private:
   std::string globString;
   llvm::Regex regex;
   HeaderType headerType;
+  size_t literalPrefixSize;
+  size_t literalSuffixSize;
   bool foundMatch{false};
 };
 
+/// A list of header globs that are matched together. Globs that end in
+/// literal text are indexed by the end of the file name it fixes, so a header
+/// is only tested against the globs that can possibly match it.
+class HeaderGlobSet {
+public:
+  void add(std::unique_ptr<HeaderGlob> glob);
+
+  /// Match the header against all globs. Every glob that matches is marked as
+  /// matched, and the result is true if any of them matched.
+  bool match(const HeaderFile &header);
+
+  llvm::ArrayRef<std::unique_ptr<HeaderGlob>> globs() const { return list; }
+  bool empty() const { return list.empty(); }
+
+private:
+  std::vector<std::unique_ptr<HeaderGlob>> list;
+  llvm::StringMap<llvm::SmallVector<HeaderGlob *, 1>> globsByFileNameSuffix;
+  std::vector<HeaderGlob *> unindexedGlobs;
+};
+
 TAPI_NAMESPACE_INTERNAL_END
 
 #endif // TAPI_CORE_HEADERGLOB_H
@@ -87,6 +87,9 @@ struct DriverOptions {
 
   /// Clang executable path.
   std::string clangExecutablePath;
+
+  /// \brief Number of parallel jobs (0 uses all available cores).
+  unsigned numThreads = 0;
 };
 
 struct ArchiveOptions {
@@ -335,6 +338,9 @@ struct TAPIOptions {
   /// \brief SDKDB output location.
   std::string sdkdbOutputPath;
 
+  /// \brief Write the partial SDKDB output in the binary format.
+  bool sdkdbBinaryFormat = false;
+
   /// \brief Path to dSYM.
   std::string dSYM;
 
@@ -61,6 +61,9 @@ struct FrontendJob {
   std::optional<std::string> clangExecutablePath;
   std::shared_ptr<SymbolVerifier> verifier =
       std::make_shared<SymbolVerifier>(SymbolVerifier());
+  /// Stream for the clang diagnostics and notes of the job. Defaults to
+  /// stderr.
+  llvm::raw_ostream *diagnosticOutput = nullptr;
 };
 
 extern llvm::Expected<FrontendContext>
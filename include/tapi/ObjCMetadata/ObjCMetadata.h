@@ -19,8 +19,10 @@
 #include <llvm/ADT/StringSet.h>
 #include <llvm/Object/MachO.h>
 #include <llvm/Support/Error.h>
+#include <optional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -266,6 +268,7 @@ public:
   const object::SectionRef getSection(const char *segname,
                                       const char *sectname) const;
   Expected<object::SectionRef> getSectionFromAddress(uint64_t Address) const;
+  std::optional<object::SectionRef> lookupSection(uint64_t Address) const;
   bool isAddressEncrypted(uint64_t Address) const;
 
   // ObjC2 helper classes
@@ -302,6 +305,28 @@ private:
   std::unordered_map<uint64_t, StringRef> VMAddrToSymbolMap;
   // Cache all RawPointer that has a VM Addr associcated with it.
   std::unordered_map<uint64_t, uint64_t> VMAddrPointToValueMap;
+
+  // Address ranges of all non-empty sections, sorted by start address.
+  struct SectionRange {
+    uint64_t Start;
+    uint64_t End;
+    object::SectionRef Section;
+  };
+  std::vector<SectionRange> SectionRanges;
+  // Sections are not expected to overlap, but if they do the lookup has to
+  // return the first section in load order like a linear scan would.
+  bool HasOverlappingSections = false;
+
+  // Segment and encryption load commands, cached for isAddressEncrypted.
+  struct SegmentRange {
+    uint64_t VMAddr;
+    uint64_t VMSize;
+    uint64_t FileOff;
+  };
+  SmallVector<SegmentRange, 8> Segments;
+  SmallVector<std::pair<uint64_t, uint64_t>, 1> EncryptedFileRanges;
+
+  void buildAddressIndex();
 };
 
 }
@@ -36,12 +36,30 @@ struct SDKDBBitcodeMaterializeOption {
   static SDKDBBitcodeMaterializeOption defaultOption;
 };
 
+/// A library that exports a symbol, as recorded in the SDKDB symbol table.
+struct SDKDBSymbolTableEntry {
+  StringRef installName;
+  // Bit offset of the API block of the library.
+  uint64_t libraryOffset = 0;
+  AvailabilityInfo availability;
+  APIAccess access = APIAccess::Unknown;
+  APILinkage linkage = APILinkage::Unknown;
+};
+
+// All the tables needed to answer queries are read when the reader is
+// created. After that the reader is immutable, and all the queries can be
+// called concurrently as long as each caller uses its own SDKDBBuilder.
 class SDKDBBitcodeReader {
 public:
   // Helper function to create SDKDBBitcodeReader.
   static llvm::Expected<std::unique_ptr<SDKDBBitcodeReader>>
   get(llvm::MemoryBufferRef input, SDKDBBitcodeMaterializeOption &option);
 
+  // Create SDKDBBitcodeReader from a file. The file is memory mapped when
+  // possible and owned by the reader.
+  static llvm::Expected<std::unique_ptr<SDKDBBitcodeReader>>
+  getFromFile(StringRef path, SDKDBBitcodeMaterializeOption &option);
+
   // Get available target triples for the SDKDB.
   const std::vector<llvm::Triple> &getAvailableTriples() const;
 
@@ -57,16 +75,25 @@ public:
   // If the SDKDB has no objc metadata.
   bool noObjCMetadata() const;
 
+  // If the SDKDB has a symbol lookup table.
+  bool hasSymbolTable() const;
+
   // Get the build verison of the SDKDB.
   std::string getBuildVersion() const;
 
   // Perform path lookup.
-  llvm::Expected<bool> dylibExistsForPath(llvm::Triple &target, StringRef path);
+  llvm::Expected<bool> dylibExistsForPath(llvm::Triple &target,
+                                          StringRef path) const;
+
+  // Look up the libraries that export the symbol from the symbol table,
+  // without materializing any library.
+  llvm::Expected<std::vector<SDKDBSymbolTableEntry>>
+  lookupSymbol(const llvm::Triple &target, StringRef name) const;
 
   // Perform API load. This will load all the dylibs from
   // SDKDBBitcodeMaterializeOption and all its re-exported frameworks.
   llvm::Error loadAPIsFromSDKDB(SDKDBBuilder &builder, llvm::Triple &target,
-                                StringRef path);
+                                StringRef path) const;
 
   // Get a vector of all the projects that had error when producing this SDKDB.
   const std::vector<std::string> &getProjectsWithError() const;
@@ -44,6 +44,36 @@ struct PartialSDKDB {
             const std::vector<API> &privateHeaderAPIs,
             bool hasErrors, bool useCompactFormat = false);
 
+  /// return true if the buffer holds a partial SDKDB in the binary format.
+  static bool isBinaryFormat(StringRef buffer);
+
+  /// return partial SDKDB with binaryInterfaces and publicHeaderInterfaces
+  /// from a binary partial SDKDB.
+  static llvm::Expected<PartialSDKDB>
+  createPublicAPIsFromBinary(StringRef buffer);
+
+  /// return partial SDKDB with binaryInterfaces and privateHeaderInterfaces
+  /// from a binary partial SDKDB.
+  static llvm::Expected<PartialSDKDB>
+  createPrivateAPIsFromBinary(StringRef buffer);
+
+  /// decode a binary partial SDKDB once and fill in the public and/or the
+  /// private partial SDKDB. Either output may be null.
+  static llvm::Error createAPIsFromBinary(StringRef buffer,
+                                          PartialSDKDB *publicOutput,
+                                          PartialSDKDB *privateOutput);
+
+  /// write partial SDKDB from APIs and FrontendContexts in the binary format.
+  /// The binary format holds exactly the content of the JSON format, but can
+  /// be read back without building a JSON DOM.
+  static llvm::Error
+  serializeBinary(llvm::raw_ostream &os, StringRef project,
+                  const std::vector<API> &binaryInterfaces,
+                  const std::vector<FrontendContext> &publicHeaderContext,
+                  const std::vector<API> &publicHeaderAPIs,
+                  const std::vector<FrontendContext> &privateHeaderContext,
+                  const std::vector<API> &privateHeaderAPIs, bool hasErrors);
+
   std::vector<API> binaryInterfaces;
   std::vector<API> headerInterfaces;
   std::string project;
@@ -51,6 +51,11 @@ public:
   /// Insert API into SDKDB and transfer the ownership.
   API &recordAPI(API &&api);
 
+  /// Record the content hash read back for a library. Libraries sharing an
+  /// install name get a combined hash.
+  void setContentHash(StringRef installName, uint64_t hash);
+  std::optional<uint64_t> getContentHash(StringRef installName) const;
+
   /// Insert APIs into global lookup map.
   void insertGlobal(GlobalRecord *record, const BinaryInfo *binInfo,
                     StringRef project);
@@ -110,8 +115,10 @@ private:
 
   template <typename T> class MapEntry {
   public:
+    /// The project name must outlive the entry. SDKDB interns the names in
+    /// projectNames, so all the entries of a project share one copy.
     MapEntry(T record, const BinaryInfo *info, StringRef project)
-        : record(record), info(info), project(project.str()), poison(false) {}
+        : record(record), info(info), project(project), poison(false) {}
 
     T getRecord() const { return record; }
     const BinaryInfo *getBinaryInfo() const { return info; }
@@ -151,7 +158,7 @@ private:
   private:
     T record;
     const BinaryInfo *info;
-    std::string project;
+    StringRef project;
     bool poison;
   };
 
@@ -230,10 +237,35 @@ private:
   /// Map from install name to the contributing project name
   llvm::StringMap<StringRef> installNames;
 
+  /// Interned project names referenced by the lookup map entries.
+  llvm::StringSet<> projectNames;
+
+  /// Return the interned copy of a project name.
+  StringRef internProjectName(StringRef project) {
+    return projectNames.insert(project).first->getKey();
+  }
+
+  /// Map from install name to the content hash recorded in the SDKDB.
+  llvm::StringMap<uint64_t> contentHashes;
+
   /// Adjacent list DAG for dylib reexports. Edges go from reexported libraries
   /// to reexporting libraries.
   llvm::StringMap<SmallVector<StringRef, 3>> reexportGraph;
 
+  /// Transitive closure of `reexportGraph`: all the libraries that eventually
+  /// reexport a library, keyed by the install name of the reexported library.
+  llvm::StringMap<llvm::StringSet<>> reexportClosure;
+
+  /// Libraries that are eventually reexported by a public library.
+  llvm::StringSet<> publiclyReexported;
+
+  /// Whether `reexportClosure` is up to date with `reexportGraph`.
+  bool hasReexportClosure = false;
+
+  /// Precompute the reexport closure so the queries below don't need to walk
+  /// `reexportGraph`.
+  void buildReexportClosure();
+
   /// Check whether `installName` is eventually reexported by `reexportedBy`
   bool isReexportedBy(StringRef installName, StringRef reexportedBy) const;
 
@@ -260,7 +292,8 @@ enum class SDKDBBuilderOptions : uint16_t {
   hasUUID = 1 << 3,           // contains UUID, defualt no.
   excludeBundles = 1 << 4,     // exclude bundles from SDKDB, default no.
   excludeEnumTypes = 1 << 5,   // exclude enums and typedefs, default no.
-  LLVM_MARK_AS_BITMASK_ENUM(excludeEnumTypes)
+  hasSymbolTable = 1 << 6,     // contains symbol lookup table, default no.
+  LLVM_MARK_AS_BITMASK_ENUM(hasSymbolTable)
 };
 
 class SDKDBBuilder {
@@ -295,6 +328,10 @@ public:
   /// Write output.
   void serialize(raw_ostream &os, bool compact) const;
 
+  /// Hash of the serialized API and the options it is written with. Equal
+  /// hashes mean the library has the same content in both SDKDBs.
+  uint64_t computeContentHash(const API &api) const;
+
   /// SDKDB private interface.
   SDKDB &getSDKDBForTarget(const llvm::Triple &triple);
 
@@ -376,6 +413,14 @@ public:
     options |= SDKDBBuilderOptions::excludeEnumTypes;
   }
 
+  bool hasSymbolTable() const {
+    return (bool)(options & SDKDBBuilderOptions::hasSymbolTable);
+  }
+
+  void setEmitSymbolTable() {
+    options |= SDKDBBuilderOptions::hasSymbolTable;
+  }
+
   void buildLookupTables();
   bool diagnoseDifferences(SDKDBBuilder &baseline);
   void setReportNewAPIasError(bool val);
@@ -392,6 +437,11 @@ public:
 
   bool setFilteredPlatforms(StringRef platform);
 
+  /// Set the number of threads used to finalize and compare the SDKDBs.
+  /// 0 uses all available cores.
+  void setNumThreads(unsigned threads) { numThreads = threads; }
+  unsigned getNumThreads() const { return numThreads; }
+
   bool shouldDiagnoseTriple(llvm::Triple triple) {
     // Only platform is checked.
     if (filterPlatforms.empty())
@@ -412,6 +462,7 @@ private:
   // Do not try to compare enums and typedefs by default.
   bool shouldDiagnoseFrontendAPI = false;
   std::unique_ptr<CompareConfigFileReader> compareConfigFileReader;
+  unsigned numThreads = 1;
 };
 
 TAPI_NAMESPACE_INTERNAL_END
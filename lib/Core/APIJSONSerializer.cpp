@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tapi/Core/APIJSONSerializer.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/JSON.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/TextAPI/PackedVersion.h"
@@ -17,12 +18,24 @@ using namespace clang;
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
+// Serializes one kind of record at a time and hands every record to the
+// caller, so the records can be written out without building the whole API
+// in memory.
 class APIJSONVisitor : public APIVisitor {
 public:
-  APIJSONVisitor(const APIJSONOption &options) : options(options) {}
-  ~APIJSONVisitor() override {}
+  enum class RecordKind {
+    Global,
+    Interface,
+    Category,
+    Protocol,
+    Enum,
+    Typedef,
+  };
 
-  friend APIJSONSerializer;
+  APIJSONVisitor(const APIJSONOption &options, RecordKind kind,
+                 function_ref<void(Object)> emit)
+      : options(options), kind(kind), emit(emit) {}
+  ~APIJSONVisitor() override {}
 
   void visitGlobal(const GlobalRecord &) override;
   void visitEnum(const EnumRecord &) override;
@@ -33,12 +46,8 @@ public:
 
 private:
   const APIJSONOption &options;
-  Array globals;
-  Array interfaces;
-  Array categories;
-  Array protocols;
-  Array enums;
-  Array typedefs;
+  RecordKind kind;
+  function_ref<void(Object)> emit;
 };
 
 class APIJSONParser {
@@ -305,6 +314,9 @@ static void serializeInstanceVariable(Array &container,
 }
 
 void APIJSONVisitor::visitGlobal(const GlobalRecord &record) {
+  if (kind != RecordKind::Global)
+    return;
+
   if (options.noHiddenGlobal && !record.isExported() && !record.inlined)
     return;
 
@@ -312,7 +324,7 @@ void APIJSONVisitor::visitGlobal(const GlobalRecord &record) {
   if (!root)
     return;
 
-  globals.emplace_back(std::move(*root));
+  emit(std::move(*root));
 }
 
 static std::optional<Object>
@@ -361,6 +373,9 @@ serializeObjCContainer(const ObjCContainerRecord &record,
 }
 
 void APIJSONVisitor::visitObjCInterface(const ObjCInterfaceRecord &interface) {
+  if (kind != RecordKind::Interface)
+    return;
+
   auto root = serializeObjCContainer(interface, options);
   if (!root)
     return;
@@ -380,23 +395,29 @@ void APIJSONVisitor::visitObjCInterface(const ObjCInterfaceRecord &interface) {
       root.value()["categories"] = std::move(categories);
   }
 
-  interfaces.emplace_back(std::move(*root));
+  emit(std::move(*root));
 }
 
 void APIJSONVisitor::visitObjCCategory(const ObjCCategoryRecord &category) {
+  if (kind != RecordKind::Category)
+    return;
+
   auto root = serializeObjCContainer(category, options);
   if (!root)
     return;
 
   root.value()["interface"] = category.interface.str();
 
-  categories.emplace_back(std::move(*root));
+  emit(std::move(*root));
 }
 
 void APIJSONVisitor::visitObjCProtocol(const ObjCProtocolRecord &protocol) {
+  if (kind != RecordKind::Protocol)
+    return;
+
   auto root = serializeObjCContainer(protocol, options);
   if (root)
-    protocols.emplace_back(std::move(*root));
+    emit(std::move(*root));
 }
 
 static std::optional<Object> serializeEnumRecord(const EnumRecord &record,
@@ -420,11 +441,14 @@ static std::optional<Object> serializeEnumRecord(const EnumRecord &record,
 }
 
 void APIJSONVisitor::visitEnum(const EnumRecord &record) {
+  if (kind != RecordKind::Enum)
+    return;
+
   auto root = serializeEnumRecord(record, options);
   if (!root)
     return;
 
-  enums.emplace_back(std::move(*root));
+  emit(std::move(*root));
 }
 
 static std::optional<Object>
@@ -438,9 +462,12 @@ serializeTypedefRecord(const TypedefRecord &record,
 }
 
 void APIJSONVisitor::visitTypeDef(const TypedefRecord &record) {
+  if (kind != RecordKind::Typedef)
+    return;
+
   auto root = serializeTypedefRecord(record, options);
   if (root)
-    typedefs.emplace_back(std::move(*root));
+    emit(std::move(*root));
 }
 
 static std::string
@@ -451,8 +478,7 @@ getPackedVersionString(const llvm::MachO::PackedVersion version) {
   return vers.str();
 }
 
-static void serializeBinaryInfo(Object &root, const BinaryInfo &binaryInfo,
-                                bool noUUID) {
+static Object serializeBinaryInfo(const BinaryInfo &binaryInfo, bool noUUID) {
   Object info;
   switch (binaryInfo.fileType) {
   case FileType::MachO_DynamicLibrary:
@@ -484,26 +510,41 @@ static void serializeBinaryInfo(Object &root, const BinaryInfo &binaryInfo,
   serializeBoolean(info, "appExtensionSafe", binaryInfo.isAppExtensionSafe);
   serializeArray(info, "allowableClients", binaryInfo.allowableClients);
   serializeArray(info, "reexportedLibraries", binaryInfo.reexportedLibraries);
-  root["binaryInfo"] = std::move(info);
+  return info;
 }
 
-static void serializePotentiallyDefinedSelectors(
-    Object &root, const StringSet<> &potentiallyDefinedSelectors) {
-  if (potentiallyDefinedSelectors.empty())
-    return;
-
+static std::vector<StringRef> getSortedPotentiallyDefinedSelectors(
+    const StringSet<> &potentiallyDefinedSelectors) {
   std::vector<StringRef> selectors;
   for (const auto &s : potentiallyDefinedSelectors)
     selectors.emplace_back(s.first());
 
   // sort the selectors for reproducibility.
   llvm::sort(selectors);
+  return selectors;
+}
+
+// Stream all the records of one kind as an array. The key is only written if
+// there is at least one record to write.
+static void serializeRecords(OStream &os, const API &api, StringRef key,
+                             APIJSONVisitor::RecordKind kind,
+                             const APIJSONOption &options) {
+  bool hasRecords = false;
+  APIJSONVisitor visitor(options, kind, [&](Object record) {
+    if (!hasRecords) {
+      os.attributeBegin(key);
+      os.arrayBegin();
+      hasRecords = true;
+    }
+    os.value(std::move(record));
+  });
+  api.visit(visitor);
 
-  Array output;
-  for (auto s : selectors)
-    output.emplace_back(s);
+  if (!hasRecords)
+    return;
 
-  root["potentiallyDefinedSelectors"] = std::move(output);
+  os.arrayEnd();
+  os.attributeEnd();
 }
 
 Object APIJSONSerializer::getJSONObject() const {
@@ -514,34 +555,94 @@ Object APIJSONSerializer::getJSONObject() const {
   if (!api.getProjectName().empty())
     root["project"] = api.getProjectName().str();
 
-  APIJSONVisitor visitor(options);
-  api.visit(visitor);
-
-  auto insertNonEmptyArray = [&](StringRef key, Array array) {
+  auto insertNonEmptyArray = [&](StringRef key,
+                                 APIJSONVisitor::RecordKind kind) {
+    Array array;
+    APIJSONVisitor visitor(options, kind, [&](Object record) {
+      array.emplace_back(std::move(record));
+    });
+    api.visit(visitor);
     if (array.empty())
       return;
     root[key] = std::move(array);
   };
-  insertNonEmptyArray("globals", visitor.globals);
-  insertNonEmptyArray("interfaces", visitor.interfaces);
-  insertNonEmptyArray("categories", visitor.categories);
-  insertNonEmptyArray("protocols", visitor.protocols);
-  insertNonEmptyArray("enums", visitor.enums);
-  insertNonEmptyArray("typedefs", visitor.typedefs);
-  serializePotentiallyDefinedSelectors(root,
-                                       api.getPotentiallyDefinedSelectors());
+  insertNonEmptyArray("globals", APIJSONVisitor::RecordKind::Global);
+  insertNonEmptyArray("interfaces", APIJSONVisitor::RecordKind::Interface);
+  insertNonEmptyArray("categories", APIJSONVisitor::RecordKind::Category);
+  insertNonEmptyArray("protocols", APIJSONVisitor::RecordKind::Protocol);
+  insertNonEmptyArray("enums", APIJSONVisitor::RecordKind::Enum);
+  insertNonEmptyArray("typedefs", APIJSONVisitor::RecordKind::Typedef);
+
+  const auto &potentiallyDefinedSelectors =
+      api.getPotentiallyDefinedSelectors();
+  if (!potentiallyDefinedSelectors.empty()) {
+    Array selectors;
+    for (auto s :
+         getSortedPotentiallyDefinedSelectors(potentiallyDefinedSelectors))
+      selectors.emplace_back(s);
+    root["potentiallyDefinedSelectors"] = std::move(selectors);
+  }
+
   if (api.hasBinaryInfo())
-    serializeBinaryInfo(root, api.getBinaryInfo(), options.noUUID);
+    root["binaryInfo"] = serializeBinaryInfo(api.getBinaryInfo(),
+                                             options.noUUID);
+
+  if (contentHash)
+    root["contentHash"] = utohexstr(contentHash());
   return root;
 }
 
+void APIJSONSerializer::serialize(OStream &os) const {
+  serializeObject(os, /*withVersion=*/false);
+}
+
+// The keys are written in the same sorted order json::Object prints them in,
+// so the output is identical to printing the result of getJSONObject(). The
+// only exception is the content hash, which is written last.
+void APIJSONSerializer::serializeObject(OStream &os, bool withVersion) const {
+  using RecordKind = APIJSONVisitor::RecordKind;
+  os.objectBegin();
+  if (withVersion)
+    os.attribute("api_json_version", 1);
+
+  if (api.hasBinaryInfo())
+    os.attribute("binaryInfo",
+                 serializeBinaryInfo(api.getBinaryInfo(), options.noUUID));
+
+  serializeRecords(os, api, "categories", RecordKind::Category, options);
+  serializeRecords(os, api, "enums", RecordKind::Enum, options);
+  serializeRecords(os, api, "globals", RecordKind::Global, options);
+  serializeRecords(os, api, "interfaces", RecordKind::Interface, options);
+
+  const auto &potentiallyDefinedSelectors =
+      api.getPotentiallyDefinedSelectors();
+  if (!potentiallyDefinedSelectors.empty()) {
+    os.attributeArray("potentiallyDefinedSelectors", [&]() {
+      for (auto s :
+           getSortedPotentiallyDefinedSelectors(potentiallyDefinedSelectors))
+        os.value(s);
+    });
+  }
+
+  if (!api.getProjectName().empty())
+    os.attribute("project", api.getProjectName());
+
+  serializeRecords(os, api, "protocols", RecordKind::Protocol, options);
+
+  if (!options.noTarget)
+    os.attribute("target", api.getTriple().str());
+
+  serializeRecords(os, api, "typedefs", RecordKind::Typedef, options);
+
+  if (contentHash)
+    os.attribute("contentHash", utohexstr(contentHash()));
+  os.objectEnd();
+}
+
 void APIJSONSerializer::serialize(raw_ostream &os) const {
-  auto root = getJSONObject();
-  root["api_json_version"] = 1;
-  if (options.compact)
-    os << formatv("{0}", Value(std::move(root))) << "\n";
-  else
-    os << formatv("{0:2}", Value(std::move(root))) << "\n";
+  OStream json(os, options.compact ? 0 : 2);
+  serializeObject(json, /*withVersion=*/true);
+  os << "\n";
 }
 
 bool APIJSONParser::parseBinaryField(StringRef key, const Object *obj) {
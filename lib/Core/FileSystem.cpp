@@ -14,6 +14,7 @@
 #include "tapi/Core/FileSystem.h"
 #include "tapi/Core/LLVM.h"
 #include "tapi/Core/Utils.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
@@ -170,14 +171,34 @@ PathMaskingOverlayFileSystem::PathMaskingOverlayFileSystem(
     IntrusiveRefCntPtr<FileSystem> base)
     : MaskingOverlayFileSystem(base) {}
 
+void PathMaskingOverlayFileSystem::addExtraMaskingDirectory(StringRef path) {
+  // Nothing to do if a shorter mask already covers the path.
+  if (isMaskedByPrefix(path))
+    return;
+
+  // Drop the masks that the new path covers. They are all sorted right after
+  // the insertion point.
+  auto it = llvm::lower_bound(extraMaskingPath, path);
+  auto end = it;
+  while (end != extraMaskingPath.end() && StringRef(*end).startswith(path))
+    ++end;
+  it = extraMaskingPath.erase(it, end);
+  extraMaskingPath.emplace(it, path.str());
+}
+
+bool PathMaskingOverlayFileSystem::isMaskedByPrefix(StringRef path) const {
+  // Every string between a mask and a path that starts with the mask also
+  // starts with the mask. No mask is a prefix of another one, so only the
+  // greatest mask that sorts before the path can be its prefix.
+  auto it = llvm::upper_bound(extraMaskingPath, path);
+  if (it == extraMaskingPath.begin())
+    return false;
+  return path.startswith(*std::prev(it));
+}
+
 bool PathMaskingOverlayFileSystem::pathMasked(const Twine &path) const {
   SmallString<PATH_MAX> realPath;
-  auto p = path.toStringRef(realPath);
-  for (auto &mask : extraMaskingPath) {
-    if (p.startswith(mask))
-      return true;
-  }
-  return false;
+  return isMaskedByPrefix(path.toStringRef(realPath));
 }
 
 PublicSDKOverlayFileSystem::PublicSDKOverlayFileSystem(
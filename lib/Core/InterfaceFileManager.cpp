@@ -15,7 +15,9 @@
 #include "tapi/Core/FileManager.h"
 #include "tapi/Core/Registry.h"
 #include "tapi/Defines.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/TextAPI/TextAPIError.h"
 
 using namespace llvm;
@@ -65,30 +67,17 @@ Expected<APIs &> InterfaceFileManager::readFile(const std::string &path,
 
 InterfaceFileManager::WriteAction
 InterfaceFileManager::shouldWrite(const std::string &path,
-                                  const InterfaceFile *file,
-                                  FileType fileType) const {
-  auto existingFile = _fm.getFile(path);
-  if (auto err = existingFile.getError())
-    return WriteAction::NewFile;
-
-  auto bufferOrErr = _fm.getBufferForFile(*existingFile,
-                                          /*RequiresNullTerminator=*/true,
-                                          /*IsVolatile=*/isVolatile);
+                                  StringRef contents) const {
+  // Read through the VFS instead of the clang FileManager, which is not safe
+  // to use from multiple threads.
+  auto bufferOrErr = _fm.getVirtualFileSystem().getBufferForFile(
+      path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false,
+      /*IsVolatile=*/isVolatile);
   if (auto err = bufferOrErr.getError())
     return WriteAction::NewFile;
 
-  if (bufferOrErr.get()->getBufferSize() == 0)
-    return WriteAction::ReplaceFile;
-
-  auto existingIFOrErr = _registry.readTextFile(std::move(bufferOrErr.get()));
-  if (auto err = existingIFOrErr.takeError()) {
-    return WriteAction::NewFile;
-  }
-  const auto existingIF = std::move(*existingIFOrErr);
-  if (existingIF->getFileType() != fileType)
-    return WriteAction::ReplaceFile;
-
-  if (*existingIF == *file)
+  // Compare the serialized bytes instead of parsing the existing file.
+  if (bufferOrErr.get()->getBuffer() == contents)
     return WriteAction::SkipWrite;
 
   return WriteAction::ReplaceFile;
@@ -97,13 +86,18 @@ InterfaceFileManager::shouldWrite(const std::string &path,
 Error InterfaceFileManager::writeFile(const std::string &path,
                                       const InterfaceFile *file,
                                       FileType fileType) const {
-  switch (shouldWrite(path, file, fileType)) {
+  SmallString<4096> contents;
+  raw_svector_ostream os(contents);
+  if (auto err = _registry.writeFile(os, file, fileType))
+    return err;
+
+  switch (shouldWrite(path, contents)) {
   case WriteAction::SkipWrite:
     return Error::success();
   case WriteAction::NewFile:
-    return _registry.writeFile(path, file, fileType, /*replaceFile=*/false);
+    return Registry::writeFileContents(path, contents, /*replaceFile=*/false);
   case WriteAction::ReplaceFile:
-    return _registry.writeFile(path, file, fileType, /*replaceFile=*/true);
+    return Registry::writeFileContents(path, contents, /*replaceFile=*/true);
   }
   llvm_unreachable("unexpected WriteAction result");
 }
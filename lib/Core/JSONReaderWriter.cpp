@@ -23,16 +23,11 @@ using namespace tapi::internal;
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
-bool JSONReader::canRead(file_magic magic, MemoryBufferRef memBufferRef,
-                         FileType types) const {
+bool JSONReader::canRead(const FileFormat &format,
+                         MemoryBufferRef memBufferRef, FileType types) const {
   if (!memBufferRef.getBufferIdentifier().endswith(".tbd"))
     return false;
-  auto result = TextAPIReader::canRead(memBufferRef);
-  if (!result) {
-    consumeError(result.takeError());
-    return false;
-  }
-  return *result >= TBD_V5;
+  return format.textFileType >= TBD_V5;
 }
 
 Expected<APIs> JSONReader::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
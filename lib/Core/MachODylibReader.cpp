@@ -31,19 +31,20 @@ using namespace llvm::object;
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
 Expected<FileType>
-MachODylibReader::getFileType(file_magic magic,
+MachODylibReader::getFileType(const FileFormat &format,
                               MemoryBufferRef bufferRef) const {
-  return getMachOFileType(bufferRef);
+  return getMachOFileType(format.magic, bufferRef);
 }
 
-bool MachODylibReader::canRead(file_magic magic, MemoryBufferRef bufferRef,
+bool MachODylibReader::canRead(const FileFormat &format,
+                               MemoryBufferRef bufferRef,
                                FileType types) const {
   if (!(types & FileType::MachO_DynamicLibrary) &&
       !(types & FileType::MachO_DynamicLibrary_Stub) &&
       !(types & FileType::MachO_Bundle))
     return false;
 
-  auto fileType = getFileType(magic, bufferRef);
+  auto fileType = getFileType(format, bufferRef);
   if (!fileType) {
     consumeError(fileType.takeError());
     return false;
@@ -12,8 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "tapi/Core/MachOReader.h"
+#include "tapi/Core/Utils.h"
 #include "tapi/ObjCMetadata/ObjCMetadata.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -30,8 +34,7 @@ using namespace llvm::MachO;
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
-Expected<FileType> getMachOFileType(MemoryBufferRef bufferRef) {
-  auto magic = identify_magic(bufferRef.getBuffer());
+static FileType getMachOFileType(file_magic magic) {
   switch (magic) {
   default:
     return FileType::Invalid;
@@ -41,57 +44,109 @@ Expected<FileType> getMachOFileType(MemoryBufferRef bufferRef) {
     return FileType::MachO_DynamicLibrary;
   case file_magic::macho_dynamically_linked_shared_lib_stub:
     return FileType::MachO_DynamicLibrary_Stub;
-  case file_magic::macho_universal_binary:
-    break;
   }
+}
 
-  auto binaryOrErr = createBinary(bufferRef);
-  if (!binaryOrErr)
-    return binaryOrErr.takeError();
+static Expected<FileType>
+getMachOFileType(file_magic magic, StringRef header, uint64_t fileSize,
+                 function_ref<Expected<StringRef>(uint64_t, uint64_t)> readAt) {
+  if (magic != file_magic::macho_universal_binary)
+    return getMachOFileType(magic);
 
-  Binary &bin = *binaryOrErr.get();
-  assert(isa<MachOUniversalBinary>(&bin) && "Unexpected MachO binary");
-  auto *UB = cast<MachOUniversalBinary>(&bin);
+  auto malformed = [](const Twine &message) {
+    return make_error<GenericBinaryError>(
+        "truncated or malformed fat file (" + message + ")",
+        object_error::parse_failed);
+  };
 
-  FileType fileType = FileType::Invalid;
-  // Check if any of the architecture slices are a MachO dylib.
-  for (auto OI = UB->begin_objects(), OE = UB->end_objects(); OI != OE; ++OI) {
-    // This can fail if the object is an archive.
-    auto objOrErr = OI->getAsObjectFile();
-    // Skip the archive and comsume the error.
-    if (!objOrErr) {
-      consumeError(objOrErr.takeError());
-      continue;
-    }
+  if (header.size() < sizeof(fat_header))
+    return malformed("fat header extends past the end of the file");
 
-    auto &obj = *objOrErr.get();
-    switch (obj.getHeader().filetype) {
-    default:
+  fat_header fatHeader;
+  memcpy(&fatHeader, header.data(), sizeof(fat_header));
+  if (sys::IsLittleEndianHost)
+    swapStruct(fatHeader);
+
+  bool is64Bit = fatHeader.magic == FAT_MAGIC_64;
+  uint64_t archSize = is64Bit ? sizeof(fat_arch_64) : sizeof(fat_arch);
+  if (sizeof(fat_header) + fatHeader.nfat_arch * archSize > fileSize)
+    return malformed("fat_arch structs extend past the end of the file");
+
+  // Only look at the Mach-O header of each slice instead of parsing the
+  // slices as object files.
+  FileType fileType = FileType::Invalid;
+  for (uint32_t i = 0; i < fatHeader.nfat_arch; ++i) {
+    uint64_t archOffset = sizeof(fat_header) + i * archSize;
+    StringRef arch;
+    if (archOffset + archSize <= header.size()) {
+      arch = header.substr(archOffset, archSize);
+    } else {
+      auto archOrErr = readAt(archOffset, archSize);
+      if (!archOrErr)
+        return archOrErr.takeError();
+      arch = *archOrErr;
+      if (arch.size() < archSize)
+        return malformed("fat_arch structs extend past the end of the file");
+    }
+
+    uint64_t offset, size;
+    if (is64Bit) {
+      fat_arch_64 fatArch;
+      memcpy(&fatArch, arch.data(), sizeof(fat_arch_64));
+      if (sys::IsLittleEndianHost)
+        swapStruct(fatArch);
+      offset = fatArch.offset;
+      size = fatArch.size;
+    } else {
+      fat_arch fatArch;
+      memcpy(&fatArch, arch.data(), sizeof(fat_arch));
+      if (sys::IsLittleEndianHost)
+        swapStruct(fatArch);
+      offset = fatArch.offset;
+      size = fatArch.size;
+    }
+    if (offset > fileSize || size > fileSize - offset)
+      return malformed("slice " + Twine(i) +
+                       " extends past the end of the file");
+
+    auto sliceOrErr =
+        readAt(offset, std::min<uint64_t>(size, sizeof(mach_header_64)));
+    if (!sliceOrErr)
+      return sliceOrErr.takeError();
+
+    // Archives and other slices that are not loadable are skipped.
+    auto sliceType = getMachOFileType(identify_magic(*sliceOrErr));
+    if (sliceType == FileType::Invalid)
       continue;
-    case MachO::MH_BUNDLE:
-      if (fileType == FileType::Invalid)
-        fileType = FileType::MachO_Bundle;
-      else if (fileType != FileType::MachO_Bundle)
-        return FileType::Invalid;
-      break;
-    case MachO::MH_DYLIB:
-      if (fileType == FileType::Invalid)
-        fileType = FileType::MachO_DynamicLibrary;
-      else if (fileType != FileType::MachO_DynamicLibrary)
-        return FileType::Invalid;
-      break;
-    case MachO::MH_DYLIB_STUB:
-      if (fileType == FileType::Invalid)
-        fileType = FileType::MachO_DynamicLibrary_Stub;
-      else if (fileType != FileType::MachO_DynamicLibrary_Stub)
-        return FileType::Invalid;
-      break;
-    }
+    if (fileType == FileType::Invalid)
+      fileType = sliceType;
+    else if (fileType != sliceType)
+      return FileType::Invalid;
   }
 
   return fileType;
 }
 
+Expected<FileType> getMachOFileType(MemoryBufferRef bufferRef) {
+  return getMachOFileType(identify_magic(bufferRef.getBuffer()), bufferRef);
+}
+
+Expected<FileType> getMachOFileType(file_magic magic,
+                                    MemoryBufferRef bufferRef) {
+  auto buffer = bufferRef.getBuffer();
+  return getMachOFileType(
+      magic, buffer, buffer.size(),
+      [buffer](uint64_t offset, uint64_t size) -> Expected<StringRef> {
+        return buffer.substr(offset, size);
+      });
+}
+
+Expected<FileType>
+getMachOFileType(StringRef header, uint64_t fileSize,
+                 function_ref<Expected<StringRef>(uint64_t, uint64_t)> readAt) {
+  return getMachOFileType(identify_magic(header), header, fileSize, readAt);
+}
+
 static Error readMachOHeader(MachOObjectFile *object, API &api) {
   auto H = object->getHeader();
   auto arch = getArchitectureFromCpuType(H.cputype, H.cpusubtype);
@@ -202,6 +257,34 @@ static Error readMachOHeader(MachOObjectFile *object, API &api) {
   return Error::success();
 }
 
+/// Copy the binary info into \p api, moving the strings into its allocator.
+static void copyBinaryInfo(const BinaryInfo &from, API &api) {
+  auto &binaryInfo = api.getBinaryInfo();
+  binaryInfo = from;
+  auto copyStrings = [&api](std::vector<StringRef> &strings) {
+    for (auto &string : strings)
+      string = api.copyString(string);
+  };
+  binaryInfo.parentUmbrella = api.copyString(from.parentUmbrella);
+  binaryInfo.installName = api.copyString(from.installName);
+  binaryInfo.uuid = api.copyString(from.uuid);
+  binaryInfo.path = api.copyString(from.path);
+  copyStrings(binaryInfo.allowableClients);
+  copyStrings(binaryInfo.reexportedLibraries);
+  copyStrings(binaryInfo.rpaths);
+  copyStrings(binaryInfo.relinkedLibraries);
+}
+
+/// Read the header of the slice once and record it in every API.
+static Error readMachOHeader(MachOObjectFile *object, ArrayRef<API *> apis) {
+  assert(!apis.empty() && "expected at least one API");
+  if (auto error = readMachOHeader(object, *apis.front()))
+    return error;
+  for (auto *api : apis.drop_front())
+    copyBinaryInfo(apis.front()->getBinaryInfo(), *api);
+  return Error::success();
+}
+
 static void DWARFErrorHandler(Error err) { /**/
 }
 
@@ -310,7 +393,8 @@ SymbolToSourceLocMap accumulateSourceLocFromDSYM(const StringRef dSYMFile,
   return SymbolToSourceLocMap();
 }
 
-static Error readSymbols(MachOObjectFile *object, API &api,
+/// Read the symbols of the slice once and record them in every API.
+static Error readSymbols(MachOObjectFile *object, ArrayRef<API *> apis,
                          const MachOParseOption &options) {
   assert(getArchitectureFromCpuType(object->getHeader().cputype,
                                     object->getHeader().cpusubtype) !=
@@ -345,8 +429,9 @@ static Error readSymbols(MachOObjectFile *object, API &api,
     // FIXME Workaround for: rdar://105047425
     // Add swift symbols from export trie.
     if (symbol.name().startswith("_$s") || symbol.name().startswith("_$S"))
-      api.addGlobalFromBinary(symbol.name().str(), flags, APILoc(),
-                              GVKind::Unknown, linkage);
+      for (auto *api : apis)
+        api->addGlobalFromBinary(symbol.name().str(), flags, APILoc(),
+                                 GVKind::Unknown, linkage);
   }
 
   for (const auto &symbol : object->symbols()) {
@@ -388,7 +473,8 @@ static Error readSymbols(MachOObjectFile *object, API &api,
     else
       apiFlags |= SymbolFlags::Data;
 
-    api.addGlobalFromBinary(name, apiFlags, APILoc(), kind, linkage);
+    for (auto *api : apis)
+      api->addGlobalFromBinary(name, apiFlags, APILoc(), kind, linkage);
   }
   return error;
 }
@@ -407,7 +493,65 @@ static ObjCPropertyRecord::AttributeKind getAttributeKind(StringRef attr) {
   return (ObjCPropertyRecord::AttributeKind)attrs;
 }
 
-static Error readObjectiveCMetadata(MachOObjectFile *object, API &api) {
+/// The records created for one ObjC container, one per target API.
+using ObjCContainerRecords = SmallVector<ObjCContainerRecord *, 2>;
+
+static Error addObjCProperties(ArrayRef<API *> apis,
+                               ArrayRef<ObjCContainerRecord *> records,
+                               Expected<ObjCPropertyList> properties) {
+  if (!properties)
+    return properties.takeError();
+
+  for (const auto &property : *properties) {
+    auto name = property.getName();
+    if (!name)
+      return name.takeError();
+
+    auto attr = property.getAttribute();
+    if (!attr)
+      return attr.takeError();
+    auto attrs = getAttributeKind(*attr);
+
+    auto setter = property.getSetter();
+    if (!setter)
+      return setter.takeError();
+    auto getter = property.getGetter();
+    if (!getter)
+      return getter.takeError();
+
+    for (auto [api, record] : zip(apis, records))
+      api->addObjCProperty(record, *name, *getter, *setter, APILoc(),
+                           AvailabilityInfo(), APIAccess::Unknown, attrs,
+                           /*isOptional=*/false, nullptr);
+  }
+
+  return Error::success();
+}
+
+static Error addObjCMethods(ArrayRef<API *> apis,
+                            ArrayRef<ObjCContainerRecord *> records,
+                            Expected<ObjCMethodList> methods,
+                            bool isInstanceMethod, bool isOptional) {
+  if (!methods)
+    return methods.takeError();
+
+  for (const auto &method : *methods) {
+    auto name = method.getName();
+    if (!name)
+      return name.takeError();
+
+    for (auto [api, record] : zip(apis, records))
+      api->addObjCMethod(record, *name, APILoc(), AvailabilityInfo(),
+                         APIAccess::Unknown, isInstanceMethod, isOptional,
+                         /*isDynamic=*/false, nullptr);
+  }
+
+  return Error::success();
+}
+
+/// Read the ObjC metadata of the slice once and record it in every API.
+static Error readObjectiveCMetadata(MachOObjectFile *object,
+                                    ArrayRef<API *> apis) {
   auto error = Error::success();
   ObjCMetaDataReader metadata(object, error);
   if (error)
@@ -434,67 +578,27 @@ static Error readObjectiveCMetadata(MachOObjectFile *object, API &api) {
       return className.takeError();
 
     // FIXME: Re-adding classes should not assume additional attributes.
-    auto *objcClass = api.addObjCInterface(
-        *className, APILoc(), AvailabilityInfo(), APIAccess::Unknown,
-        APILinkage::Exported, *superClassName, nullptr,
-        ObjCIFSymbolKind::Class | ObjCIFSymbolKind::MetaClass,
-        /*overrideLinkage=*/false);
-
-    auto properties = objcClassMeta->properties();
-    if (!properties)
-      return properties.takeError();
-
-    for (const auto &property : *properties) {
-      auto name = property.getName();
-      if (!name)
-        return name.takeError();
-
-      auto attr = property.getAttribute();
-      if (!attr)
-        return attr.takeError();
-      auto attrs = getAttributeKind(*attr);
-
-      auto setter = property.getSetter();
-      if (!setter)
-        return setter.takeError();
-      auto getter = property.getGetter();
-      if (!getter)
-        return getter.takeError();
-
-      api.addObjCProperty(objcClass, *name, *getter, *setter, APILoc(),
-                          AvailabilityInfo(), APIAccess::Unknown, attrs,
-                          /*isOptional=*/false, nullptr);
-    }
-
-    auto classMethods = objcClassMeta->classMethods();
-    if (!classMethods)
-      return classMethods.takeError();
-
-    for (const auto &method : *classMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcClass, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/false, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
-
-    auto instanceMethods = objcClassMeta->instanceMethods();
-    if (!instanceMethods)
-      return instanceMethods.takeError();
-
-    for (const auto &method : *instanceMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcClass, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/true, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
+    ObjCContainerRecords objcClasses;
+    for (auto *api : apis)
+      objcClasses.push_back(api->addObjCInterface(
+          *className, APILoc(), AvailabilityInfo(), APIAccess::Unknown,
+          APILinkage::Exported, *superClassName, nullptr,
+          ObjCIFSymbolKind::Class | ObjCIFSymbolKind::MetaClass,
+          /*overrideLinkage=*/false));
+
+    if (auto err =
+            addObjCProperties(apis, objcClasses, objcClassMeta->properties()))
+      return err;
+    if (auto err = addObjCMethods(apis, objcClasses,
+                                  objcClassMeta->classMethods(),
+                                  /*isInstanceMethod=*/false,
+                                  /*isOptional=*/false))
+      return err;
+    if (auto err = addObjCMethods(apis, objcClasses,
+                                  objcClassMeta->instanceMethods(),
+                                  /*isInstanceMethod=*/true,
+                                  /*isOptional=*/false))
+      return err;
   }
 
   ///
@@ -517,65 +621,26 @@ static Error readObjectiveCMetadata(MachOObjectFile *object, API &api) {
     if (!baseClassName)
       return baseClassName.takeError();
 
-    auto *objcCategory =
-        api.addObjCCategory(*baseClassName, *categoryName, APILoc(),
-                            AvailabilityInfo(), APIAccess::Unknown, nullptr);
-
-    auto properties = category->properties();
-    if (!properties)
-      return properties.takeError();
-
-    for (const auto &property : *properties) {
-      auto name = property.getName();
-      if (!name)
-        return name.takeError();
-
-      auto attr = property.getAttribute();
-      if (!attr)
-        return attr.takeError();
-      auto attrs = getAttributeKind(*attr);
-
-      auto setter = property.getSetter();
-      if (!setter)
-        return setter.takeError();
-      auto getter = property.getGetter();
-      if (!getter)
-        return getter.takeError();
-
-      api.addObjCProperty(objcCategory, *name, *getter, *setter, APILoc(),
-                          AvailabilityInfo(), APIAccess::Unknown, attrs,
-                          /*isOptional=*/false, nullptr);
-    }
-
-    auto classMethods = category->classMethods();
-    if (!classMethods)
-      return classMethods.takeError();
-
-    for (const auto &method : *classMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcCategory, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/false, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
-
-    auto instanceMethods = category->instanceMethods();
-    if (!instanceMethods)
-      return instanceMethods.takeError();
-
-    for (const auto &method : *instanceMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcCategory, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/true, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
+    ObjCContainerRecords objcCategories;
+    for (auto *api : apis)
+      objcCategories.push_back(
+          api->addObjCCategory(*baseClassName, *categoryName, APILoc(),
+                               AvailabilityInfo(), APIAccess::Unknown,
+                               nullptr));
+
+    if (auto err =
+            addObjCProperties(apis, objcCategories, category->properties()))
+      return err;
+    if (auto err = addObjCMethods(apis, objcCategories,
+                                  category->classMethods(),
+                                  /*isInstanceMethod=*/false,
+                                  /*isOptional=*/false))
+      return err;
+    if (auto err = addObjCMethods(apis, objcCategories,
+                                  category->instanceMethods(),
+                                  /*isInstanceMethod=*/true,
+                                  /*isOptional=*/false))
+      return err;
   }
 
   ///
@@ -594,121 +659,73 @@ static Error readObjectiveCMetadata(MachOObjectFile *object, API &api) {
     if (!protocolName)
       return protocolName.takeError();
 
-    auto *objcProtocol =
-        api.addObjCProtocol(*protocolName, APILoc(), AvailabilityInfo(),
-                            APIAccess::Unknown, nullptr);
-
-    auto properties = protocol->properties();
-    if (!properties)
-      return properties.takeError();
-
-    for (const auto &property : *properties) {
-      auto name = property.getName();
-      if (!name)
-        return name.takeError();
-
-      auto attr = property.getAttribute();
-      if (!attr)
-        return attr.takeError();
-      auto attrs = getAttributeKind(*attr);
-
-      auto setter = property.getSetter();
-      if (!setter)
-        return setter.takeError();
-      auto getter = property.getGetter();
-      if (!getter)
-        return getter.takeError();
-
-      api.addObjCProperty(objcProtocol, *name, *getter, *setter, APILoc(),
-                          AvailabilityInfo(), APIAccess::Unknown, attrs,
-                          /*isOptional=*/false, nullptr);
-    }
-
-    auto classMethods = protocol->classMethods();
-    if (!classMethods)
-      return classMethods.takeError();
-
-    for (const auto &method : *classMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcProtocol, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/false, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
-
-    classMethods = protocol->optionalClassMethods();
-    if (!classMethods)
-      return classMethods.takeError();
-
-    for (const auto &method : *classMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcProtocol, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/false, /*isOptional=*/true,
-                        /*isDynamic=*/false, nullptr);
-    }
-
-    auto instanceMethods = protocol->instanceMethods();
-    if (!instanceMethods)
-      return instanceMethods.takeError();
-
-    for (const auto &method : *instanceMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcProtocol, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/true, /*isOptional=*/false,
-                        /*isDynamic=*/false, nullptr);
-    }
-
-    instanceMethods = protocol->optionalInstanceMethods();
-    if (!instanceMethods)
-      return instanceMethods.takeError();
-
-    for (const auto &method : *instanceMethods) {
-      auto name = method.getName();
-      if (!name)
-        return name.takeError();
-
-      api.addObjCMethod(objcProtocol, *name, APILoc(), AvailabilityInfo(),
-                        APIAccess::Unknown,
-                        /*isInstanceMethod=*/true, /*isOptional=*/true,
-                        /*isDynamic=*/false, nullptr);
-    }
+    ObjCContainerRecords objcProtocols;
+    for (auto *api : apis)
+      objcProtocols.push_back(
+          api->addObjCProtocol(*protocolName, APILoc(), AvailabilityInfo(),
+                               APIAccess::Unknown, nullptr));
+
+    if (auto err =
+            addObjCProperties(apis, objcProtocols, protocol->properties()))
+      return err;
+    if (auto err = addObjCMethods(apis, objcProtocols,
+                                  protocol->classMethods(),
+                                  /*isInstanceMethod=*/false,
+                                  /*isOptional=*/false))
+      return err;
+    if (auto err = addObjCMethods(apis, objcProtocols,
+                                  protocol->optionalClassMethods(),
+                                  /*isInstanceMethod=*/false,
+                                  /*isOptional=*/true))
+      return err;
+    if (auto err = addObjCMethods(apis, objcProtocols,
+                                  protocol->instanceMethods(),
+                                  /*isInstanceMethod=*/true,
+                                  /*isOptional=*/false))
+      return err;
+    if (auto err = addObjCMethods(apis, objcProtocols,
+                                  protocol->optionalInstanceMethods(),
+                                  /*isInstanceMethod=*/true,
+                                  /*isOptional=*/true))
+      return err;
   }
 
   // Potentially defined selectors for swift.
   // Swift compiler generates certain data structure which can dynamically
   // constructing objc metadata.
-  if (api.hasBinaryInfo() && api.getBinaryInfo().swiftABIVersion != 0)
-    metadata.getAllPotentiallyDefinedSelectors(
-        api.getPotentiallyDefinedSelectors());
+  StringSet<> selectors;
+  bool collectedSelectors = false;
+  for (auto *api : apis) {
+    if (!api->hasBinaryInfo() || api->getBinaryInfo().swiftABIVersion == 0)
+      continue;
+    if (!collectedSelectors) {
+      metadata.getAllPotentiallyDefinedSelectors(selectors);
+      collectedSelectors = true;
+    }
+    for (const auto &selector : selectors)
+      api->getPotentiallyDefinedSelectors().insert(selector.getKey());
+  }
 
   return Error::success();
 }
 
-static Error load(MachOObjectFile *object, API &api, MachOParseOption &option) {
+/// Load the slice into the APIs of all its targets. Every part of the binary
+/// is parsed only once, no matter how many targets the slice has.
+static Error load(MachOObjectFile *object, ArrayRef<API *> apis,
+                  MachOParseOption &option) {
   if (option.parseMachOHeader) {
-    auto error = readMachOHeader(object, api);
+    auto error = readMachOHeader(object, apis);
     if (error)
       return error;
   }
   if (option.parseSymbolTable) {
-    auto error = readSymbols(object, api, option);
+    auto error = readSymbols(object, apis, option);
     if (error)
       return error;
   }
 
   if (option.parseObjCMetadata) {
-    auto error = readObjectiveCMetadata(object, api);
+    auto error = readObjectiveCMetadata(object, apis);
     if (error)
       return error;
   }
@@ -854,17 +871,20 @@ llvm::Expected<MachOParseResult> readMachOFile(MemoryBufferRef memBuffer,
           std::make_error_code(std::errc::not_supported));
 
     auto triples = constructTripleFromMachO(object);
+    SmallVector<API *, 2> apis;
     for (const auto &target : triples) {
       if (mapToPlatformType(target) == PLATFORM_UNKNOWN)
         return make_error<StringError>(
             "unknown/unsupported platform",
             std::make_error_code(std::errc::not_supported));
       results.emplace_back(arch, std::make_shared<API>(API({target})));
-      auto error = load(object, *results.back().second, option);
-      if (error)
-        return std::move(error);
+      apis.push_back(results.back().second.get());
     }
 
+    auto error = load(object, apis, option);
+    if (error)
+      return std::move(error);
+
     return results;
   }
 
@@ -873,6 +893,13 @@ llvm::Expected<MachOParseResult> readMachOFile(MemoryBufferRef memBuffer,
          "Expected a MachO universal binary.");
   auto *UB = cast<MachOUniversalBinary>(&binary);
 
+  // A slice of the universal binary, with the APIs of all its targets.
+  struct UniversalSlice {
+    std::unique_ptr<MachOObjectFile> object;
+    SmallVector<API *, 2> apis;
+    std::optional<Error> error;
+  };
+  std::vector<UniversalSlice> slices;
   for (auto OI = UB->begin_objects(), OE = UB->end_objects(); OI != OE; ++OI) {
     // Skip the architecture that is not requested.
     auto arch =
@@ -893,23 +920,41 @@ llvm::Expected<MachOParseResult> readMachOFile(MemoryBufferRef memBuffer,
       continue;
     }
 
-    auto &object = *objOrErr.get();
-    auto triples = constructTripleFromMachO(&object);
-    switch (object.getHeader().filetype) {
+    switch (objOrErr.get()->getHeader().filetype) {
     default:
       break;
     case MachO::MH_BUNDLE:
     case MachO::MH_DYLIB:
-    case MachO::MH_DYLIB_STUB:
-      for (const auto &target : triples) {
+    case MachO::MH_DYLIB_STUB: {
+      UniversalSlice slice;
+      slice.object = std::move(*objOrErr);
+      for (const auto &target : constructTripleFromMachO(slice.object.get())) {
         results.emplace_back(arch, std::make_shared<API>(API({target})));
-        auto error = load(&object, *results.back().second, option);
-        if (error)
-          return std::move(error);
+        slice.apis.push_back(results.back().second.get());
       }
+      slices.emplace_back(std::move(slice));
       break;
     }
+    }
+  }
+
+  // The slices don't share any state, so they are loaded on the worker pool.
+  // The results were already recorded in slice order above.
+  parallelForEachIndex(slices.size(), option.numThreads, [&](size_t i) {
+    auto &slice = slices[i];
+    slice.error.emplace(load(slice.object.get(), slice.apis, option));
+  });
+
+  // Return the error of the first slice that failed, but check all of them.
+  Error error = Error::success();
+  for (auto &slice : slices) {
+    if (error)
+      consumeError(std::move(*slice.error));
+    else
+      error = std::move(*slice.error);
   }
+  if (error)
+    return std::move(error);
 
   if (results.empty())
     return make_error<StringError>(
@@ -33,9 +33,9 @@ namespace {
 class DiagnosticReader : public Reader {
 public:
   DiagnosticReader() : Reader(Diagnostic) {}
-  bool canRead(file_magic fileType, MemoryBufferRef bufferRef,
+  bool canRead(const FileFormat &format, MemoryBufferRef bufferRef,
                FileType types = FileType::All) const override;
-  Expected<FileType> getFileType(file_magic magic,
+  Expected<FileType> getFileType(const FileFormat &format,
                                  MemoryBufferRef bufferRef) const override;
   Expected<APIs> readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                           ReadFlags readFlags,
@@ -48,7 +48,23 @@ public:
 
 } // namespace
 
-bool DiagnosticReader::canRead(file_magic fileType, MemoryBufferRef bufferRef,
+FileFormat FileFormat::detect(MemoryBufferRef bufferRef) {
+  FileFormat format;
+  auto buffer = bufferRef.getBuffer();
+  format.magic = identify_magic(buffer);
+  // Text-based stubs may start with white space.
+  if (format.magic == file_magic::unknown)
+    format.magic = identify_magic(buffer.ltrim());
+  auto textFileType = TextAPIReader::canRead(bufferRef);
+  if (!textFileType)
+    consumeError(textFileType.takeError());
+  else
+    format.textFileType = *textFileType;
+  return format;
+}
+
+bool DiagnosticReader::canRead(const FileFormat &format,
+                               MemoryBufferRef bufferRef,
                                FileType types) const {
   auto str = bufferRef.getBuffer().trim();
   if (!str.startswith("--- !tapi") || !str.endswith("..."))
@@ -58,7 +74,7 @@ bool DiagnosticReader::canRead(file_magic fileType, MemoryBufferRef bufferRef,
 }
 
 Expected<FileType>
-DiagnosticReader::getFileType(file_magic magic,
+DiagnosticReader::getFileType(const FileFormat &format,
                               MemoryBufferRef bufferRef) const {
   return Invalid;
 }
@@ -74,11 +90,9 @@ DiagnosticReader::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
 }
 
 bool Registry::canRead(MemoryBufferRef memBuffer, FileType types) const {
-  auto data = memBuffer.getBuffer();
-  auto magic = identify_magic(data);
-
+  auto format = FileFormat::detect(memBuffer);
   for (const auto &reader : _readers) {
-    if (reader->canRead(magic, memBuffer, types))
+    if (reader->canRead(format, memBuffer, types))
       return true;
   }
 
@@ -86,11 +100,9 @@ bool Registry::canRead(MemoryBufferRef memBuffer, FileType types) const {
 }
 
 Expected<FileType> Registry::getFileType(MemoryBufferRef memBuffer) const {
-  auto data = memBuffer.getBuffer();
-  auto magic = identify_magic(data);
-
+  auto format = FileFormat::detect(memBuffer);
   for (const auto &reader : _readers) {
-    auto fileType = reader->getFileType(magic, memBuffer);
+    auto fileType = reader->getFileType(format, memBuffer);
     if (!fileType)
       return fileType.takeError();
     if (fileType.get() != FileType::Invalid)
@@ -112,11 +124,9 @@ bool Registry::canWrite(const InterfaceFile *file, FileType fileType) const {
 Expected<APIs> Registry::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                                   ReadFlags readFlags,
                                   ArchitectureSet arches) const {
-  auto data = memBuffer->getBuffer();
-  auto fileType = identify_magic(data);
-
+  auto format = FileFormat::detect(memBuffer->getMemBufferRef());
   for (const auto &reader : _readers) {
-    if (!reader->canRead(fileType, memBuffer->getMemBufferRef()))
+    if (!reader->canRead(format, memBuffer->getMemBufferRef()))
       continue;
     return reader->readFile(std::move(memBuffer), readFlags, arches);
   }
@@ -128,15 +138,13 @@ Expected<APIs> Registry::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
 Expected<std::unique_ptr<InterfaceFile>>
 Registry::readTextFile(std::unique_ptr<MemoryBuffer> memBuffer, ReadFlags readFlags,
                    ArchitectureSet arches) const {
-  auto data = memBuffer->getBuffer().trim();
-  auto fileType = identify_magic(data);
-
-  if (fileType != file_magic::tapi_file)
+  auto format = FileFormat::detect(memBuffer->getMemBufferRef());
+  if (format.magic != file_magic::tapi_file)
     return make_error<StringError>(
       "unsupported file type", std::make_error_code(std::errc::not_supported));
 
   for (const auto &reader : _readers) {
-    if (!reader->canRead(fileType, memBuffer->getMemBufferRef()))
+    if (!reader->canRead(format, memBuffer->getMemBufferRef()))
       continue;
 
     auto interfaceOrErr = TextAPIReader::get(memBuffer->getMemBufferRef());
@@ -157,14 +165,16 @@ Registry::readTextFile(std::unique_ptr<MemoryBuffer> memBuffer, ReadFlags readFl
 // atomically rename it to the final destination(path), if requested to replace
 // existing file. This approach was taken from
 // CompilerInstance::createOutputFile, which is non static member function.
-Error Registry::writeFile(const std::string &path, const InterfaceFile *file,
-                          FileType fileType, bool replaceFile) const {
+/// Write to \p path through \p write, using a temporary file if
+/// \p replaceFile is set.
+static Error writeToPath(const std::string &path, bool replaceFile,
+                         function_ref<Error(raw_ostream &)> write) {
   using namespace llvm::sys;
 
   auto writeFileWithoutTemporary = [&]() -> Error {
     std::error_code error;
     llvm::raw_fd_ostream os(path, error, fs::OF_None);
-    if (auto error = writeFile(os, file, fileType))
+    if (auto error = write(os))
       return error;
     return Error::success();
   };
@@ -188,7 +198,7 @@ Error Registry::writeFile(const std::string &path, const InterfaceFile *file,
     return writeFileWithoutTemporary();
 
   llvm::raw_fd_ostream os(fd, /*shouldClose*/ true);
-  if (auto error = writeFile(os, file, fileType))
+  if (auto error = write(os))
     return error;
 
   if (auto error = fs::rename(tmpPath, path))
@@ -197,6 +207,21 @@ Error Registry::writeFile(const std::string &path, const InterfaceFile *file,
   return Error::success();
 }
 
+Error Registry::writeFile(const std::string &path, const InterfaceFile *file,
+                          FileType fileType, bool replaceFile) const {
+  return writeToPath(path, replaceFile, [&](raw_ostream &os) {
+    return writeFile(os, file, fileType);
+  });
+}
+
+Error Registry::writeFileContents(const std::string &path, StringRef contents,
+                                  bool replaceFile) {
+  return writeToPath(path, replaceFile, [&](raw_ostream &os) {
+    os << contents;
+    return Error::success();
+  });
+}
+
 Error Registry::writeFile(raw_ostream &os, const InterfaceFile *file,
                           FileType fileType) const {
   for (const auto &writer : _writers) {
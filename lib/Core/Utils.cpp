@@ -22,6 +22,9 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -175,6 +178,29 @@ std::string findLibrary(StringRef installName, FileManager &fm,
   return std::string();
 }
 
+void parallelForEachIndex(size_t count, unsigned numThreads,
+                          function_ref<void(size_t)> func) {
+  auto strategy = hardware_concurrency(numThreads);
+  size_t numWorkers =
+      std::min<size_t>(strategy.compute_thread_count(), count);
+  if (numWorkers <= 1) {
+    for (size_t i = 0; i < count; ++i)
+      func(i);
+    return;
+  }
+
+  // Workers pull the next index from a shared counter, so a few expensive
+  // items don't leave the rest of the pool idle.
+  std::atomic<size_t> next{0};
+  ThreadPool pool(hardware_concurrency(numWorkers));
+  for (size_t worker = 0; worker < numWorkers; ++worker)
+    pool.async([&]() {
+      for (size_t i = next++; i < count; i = next++)
+        func(i);
+    });
+  pool.wait();
+}
+
 namespace {
 
 std::unique_ptr<InterfaceFile> createInterfaceFile(const APIs &apis,
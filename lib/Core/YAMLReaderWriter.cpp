@@ -27,21 +27,16 @@ using namespace tapi::internal;
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
 namespace stub::v1 {
-bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
+bool YAMLDocumentHandler::canRead(FileType textFileType,
                                   FileType types) const {
   if (!(types & FileType::TBD_V1))
     return false;
 
-  auto result = TextAPIReader::canRead(memBufferRef);
-  if (!result) {
-    consumeError(result.takeError());
-    return false;
-  }
-  return *result == FileType::TBD_V1;
+  return textFileType == FileType::TBD_V1;
 }
 
-FileType YAMLDocumentHandler::getFileType(MemoryBufferRef memBufferRef) const {
-  if (canRead(memBufferRef))
+FileType YAMLDocumentHandler::getFileType(FileType textFileType) const {
+  if (canRead(textFileType))
     return FileType::TBD_V1;
 
   return FileType::Invalid;
@@ -62,21 +57,16 @@ bool YAMLDocumentHandler::canWrite(const InterfaceFile *file,
 
 namespace stub::v2 {
 
-bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
+bool YAMLDocumentHandler::canRead(FileType textFileType,
                                   FileType types) const {
   if (!(types & FileType::TBD_V2))
     return false;
 
-  auto result = TextAPIReader::canRead(memBufferRef);
-  if (!result) {
-    consumeError(result.takeError());
-    return false;
-  }
-  return *result == FileType::TBD_V2;
+  return textFileType == FileType::TBD_V2;
 }
 
-FileType YAMLDocumentHandler::getFileType(MemoryBufferRef memBufferRef) const {
-  if (canRead(memBufferRef))
+FileType YAMLDocumentHandler::getFileType(FileType textFileType) const {
+  if (canRead(textFileType))
     return FileType::TBD_V2;
 
   return FileType::Invalid;
@@ -92,21 +82,16 @@ bool YAMLDocumentHandler::canWrite(const InterfaceFile *file,
 } // end namespace stub::v2
 
 namespace stub::v3 {
-bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
+bool YAMLDocumentHandler::canRead(FileType textFileType,
                                   FileType types) const {
   if (!(types & FileType::TBD_V3))
     return false;
 
-  auto result = TextAPIReader::canRead(memBufferRef);
-  if (!result) {
-    consumeError(result.takeError());
-    return false;
-  }
-  return *result == FileType::TBD_V3;
+  return textFileType == FileType::TBD_V3;
 }
 
-FileType YAMLDocumentHandler::getFileType(MemoryBufferRef memBufferRef) const {
-  if (canRead(memBufferRef))
+FileType YAMLDocumentHandler::getFileType(FileType textFileType) const {
+  if (canRead(textFileType))
     return FileType::TBD_V3;
 
   return FileType::Invalid;
@@ -124,21 +109,16 @@ bool YAMLDocumentHandler::canWrite(const InterfaceFile *file,
 
 namespace stub::v4 {
 
-bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
+bool YAMLDocumentHandler::canRead(FileType textFileType,
                                   FileType types) const {
   if (!(types & FileType::TBD_V4))
     return false;
 
-  auto result = TextAPIReader::canRead(memBufferRef);
-  if (!result) {
-    consumeError(result.takeError());
-    return false;
-  }
-  return *result == FileType::TBD_V4;
+  return textFileType == FileType::TBD_V4;
 }
 
-FileType YAMLDocumentHandler::getFileType(MemoryBufferRef memBufferRef) const {
-  if (canRead(memBufferRef))
+FileType YAMLDocumentHandler::getFileType(FileType textFileType) const {
+  if (canRead(textFileType))
     return FileType::TBD_V4;
 
   return FileType::Invalid;
@@ -153,9 +133,9 @@ bool YAMLDocumentHandler::canWrite(const InterfaceFile *file,
 }
 } // end namespace stub::v4
 
-bool YAMLBase::canRead(MemoryBufferRef memBufferRef, FileType types) const {
+bool YAMLBase::canRead(FileType textFileType, FileType types) const {
   for (const auto &handler : _documentHandlers) {
-    if (handler->canRead(memBufferRef, types))
+    if (handler->canRead(textFileType, types))
       return true;
   }
   return false;
@@ -169,9 +149,9 @@ bool YAMLBase::canWrite(const InterfaceFile *file, FileType fileType) const {
   return false;
 }
 
-FileType YAMLBase::getFileType(MemoryBufferRef bufferRef) const {
+FileType YAMLBase::getFileType(FileType textFileType) const {
   for (const auto &handler : _documentHandlers) {
-    auto fileType = handler->getFileType(bufferRef);
+    auto fileType = handler->getFileType(textFileType);
     if (fileType != FileType::Invalid)
       return fileType;
   }
@@ -187,14 +167,14 @@ bool YAMLBase::writeFile(raw_ostream &os, const InterfaceFile *file,
   return false;
 }
 
-bool YAMLReader::canRead(file_magic magic, MemoryBufferRef memBufferRef,
-                         FileType types) const {
-  return YAMLBase::canRead(memBufferRef, types);
+bool YAMLReader::canRead(const FileFormat &format,
+                         MemoryBufferRef memBufferRef, FileType types) const {
+  return YAMLBase::canRead(format.textFileType, types);
 }
 
-Expected<FileType> YAMLReader::getFileType(file_magic magic,
+Expected<FileType> YAMLReader::getFileType(const FileFormat &format,
                                            MemoryBufferRef memBufferRef) const {
-  return YAMLBase::getFileType(memBufferRef);
+  return YAMLBase::getFileType(format.textFileType);
 }
 
 void addInterfaceFileToAPIs(APIs &apis, const InterfaceFile *interface) {
@@ -26,6 +26,100 @@ using namespace llvm::MachO;
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
+/// \brief Verify that \p file can be merged into a library with the
+/// attributes of \p first. This performs the same checks as
+/// InterfaceFile::merge.
+static Error verifyMergeable(const InterfaceFile &first,
+                             const InterfaceFile &file,
+                             uint8_t swiftABIVersion) {
+  if (first.getInstallName() != file.getInstallName())
+    return make_error<StringError>("install names do not match",
+                                   inconvertibleErrorCode());
+
+  if (first.getCurrentVersion() != file.getCurrentVersion())
+    return make_error<StringError>("current versions do not match",
+                                   inconvertibleErrorCode());
+
+  if (first.getCompatibilityVersion() != file.getCompatibilityVersion())
+    return make_error<StringError>("compatibility versions do not match",
+                                   inconvertibleErrorCode());
+
+  if ((swiftABIVersion != 0) && (file.getSwiftABIVersion() != 0) &&
+      (swiftABIVersion != file.getSwiftABIVersion()))
+    return make_error<StringError>("swift ABI versions do not match",
+                                   inconvertibleErrorCode());
+
+  if (first.isTwoLevelNamespace() != file.isTwoLevelNamespace())
+    return make_error<StringError>("two level namespace flags do not match",
+                                   inconvertibleErrorCode());
+
+  if (first.isApplicationExtensionSafe() != file.isApplicationExtensionSafe())
+    return make_error<StringError>(
+        "application extension safe flags do not match",
+        inconvertibleErrorCode());
+
+  return Error::success();
+}
+
+/// \brief Merge all input files into a single interface file.
+///
+/// Folding the inputs with InterfaceFile::merge copies the accumulated
+/// result for every input, which is quadratic in the number of inputs. Build
+/// the output once instead and add the content of every input to it in
+/// order, which produces the same result with linear total work.
+static std::unique_ptr<InterfaceFile>
+mergeInterfaceFiles(DiagnosticsEngine &diag,
+                    ArrayRef<std::unique_ptr<InterfaceFile>> inputs) {
+  const auto &first = *inputs.front();
+  auto fileType = first.getFileType();
+  auto swiftABIVersion = first.getSwiftABIVersion();
+  for (const auto &file : inputs.drop_front()) {
+    if (auto err = verifyMergeable(first, *file, swiftABIVersion)) {
+      diag.report(diag::err) << file->getPath() << toString(std::move(err));
+      return nullptr;
+    }
+    fileType = std::max(fileType, file->getFileType());
+    if (swiftABIVersion == 0)
+      swiftABIVersion = file->getSwiftABIVersion();
+  }
+
+  auto output = std::make_unique<InterfaceFile>();
+  output->setFileType(fileType);
+  output->setPath(first.getPath());
+  output->setInstallName(first.getInstallName());
+  output->setCurrentVersion(first.getCurrentVersion());
+  output->setCompatibilityVersion(first.getCompatibilityVersion());
+  output->setSwiftABIVersion(swiftABIVersion);
+  output->setTwoLevelNamespace(first.isTwoLevelNamespace());
+  output->setApplicationExtensionSafe(first.isApplicationExtensionSafe());
+  output->setOSLibNotForSharedCache(first.isOSLibNotForSharedCache());
+
+  for (const auto &file : inputs) {
+    for (const auto &[target, umbrella] : file->umbrellas())
+      if (!umbrella.empty())
+        output->addParentUmbrella(target, umbrella);
+
+    output->addTargets(file->targets());
+
+    for (const auto &lib : file->allowableClients())
+      for (const auto &target : lib.targets())
+        output->addAllowableClient(lib.getInstallName(), target);
+
+    for (const auto &lib : file->reexportedLibraries())
+      for (const auto &target : lib.targets())
+        output->addReexportedLibrary(lib.getInstallName(), target);
+
+    for (const auto &[target, path] : file->rpaths())
+      output->addRPath(target, path);
+
+    for (const auto *sym : file->symbols())
+      output->addSymbol(sym->getKind(), sym->getName(), sym->targets(),
+                        sym->getFlags());
+  }
+
+  return output;
+}
+
 /// \brief Merge or thin text-based stub files.
 bool Driver::Archive::run(DiagnosticsEngine &diag, Options &opts) {
   auto &fm = opts.getFileManager();
@@ -146,20 +240,14 @@ bool Driver::Archive::run(DiagnosticsEngine &diag, Options &opts) {
 
   case ArchiveAction::Merge: {
     assert(!inputs.empty() && "expecting at least one input file");
-    for (auto &file : inputs) {
-      if (!output) {
-        output = std::move(file);
-        continue;
-      }
-
-      auto result = output->merge(file.get());
-      if (!result) {
-        diag.report(diag::err)
-            << file->getPath() << toString(result.takeError());
-        return false;
-      }
-      output = std::move(result.get());
+    if (inputs.size() == 1) {
+      output = std::move(inputs.front());
+      break;
     }
+
+    output = mergeInterfaceFiles(diag, inputs);
+    if (!output)
+      return false;
     break;
   }
   case ArchiveAction::ListSymbols: {
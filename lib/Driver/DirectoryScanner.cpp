@@ -17,9 +17,11 @@
 #include "tapi/Core/FileManager.h"
 #include "tapi/Core/Framework.h"
 #include "tapi/Core/HeaderFile.h"
+#include "tapi/Core/MachOReader.h"
 #include "tapi/Core/Utils.h"
 #include "tapi/Diagnostics/Diagnostics.h"
 #include "clang/Basic/Diagnostic.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/VirtualFileSystem.h"
@@ -55,10 +57,203 @@ bool ScannerMode::isRootLayout() const {
   return mode != ScanFrameworks && mode != ScanDylibs;
 }
 
+/// Number of bytes read from the start of a file to determine its type. This
+/// covers the Mach-O header and the architecture table of universal binaries.
+static constexpr uint64_t fileHeaderSize = 512;
+
+DirectoryCache::DirectoryCache(FileManager &fm) : _fm(fm) {}
+
+DirectoryCache::Listing DirectoryCache::readListing(StringRef directory) const {
+  // Only the VFS is used here, because the clang FileManager is not safe to
+  // use from multiple threads.
+  Listing listing;
+  std::error_code ec;
+  auto &fs = _fm.getVirtualFileSystem();
+  for (vfs::directory_iterator i = fs.dir_begin(directory, ec), ie; i != ie;
+       i.increment(ec)) {
+    auto path = i->path();
+
+    // Remember files that not exist. This usually happens for broken
+    // symlinks.
+    if (ec == std::errc::no_such_file_or_directory) {
+      listing.entries.push_back({path.str(), EntryKind::Missing, false, ec});
+      ec.clear();
+      continue;
+    }
+
+    if (ec) {
+      listing.ec = ec;
+      listing.errorPath = path.str();
+      break;
+    }
+
+    auto status = fs.status(path);
+    auto kind = !status                ? EntryKind::Missing
+                : status->isDirectory() ? EntryKind::Directory
+                                        : EntryKind::File;
+    listing.entries.push_back({path.str(), kind, _fm.isSymlink(path)});
+  }
+
+  return listing;
+}
+
+DirectoryCache::FileInfo DirectoryCache::readFileInfo(StringRef path) const {
+  FileInfo info;
+  auto fileOrErr = _fm.getVirtualFileSystem().openFileForRead(path);
+  if (auto ec = fileOrErr.getError()) {
+    info.ec = ec;
+    return info;
+  }
+
+  auto &file = *fileOrErr.get();
+  auto status = file.status();
+  if (auto ec = status.getError()) {
+    info.ec = ec;
+    return info;
+  }
+
+  // Only read the start of the file instead of the whole binary.
+  uint64_t fileSize = status->getSize();
+  auto headerOrErr = file.getBuffer(path, std::min(fileSize, fileHeaderSize),
+                                    /*RequiresNullTerminator=*/false);
+  if (auto ec = headerOrErr.getError()) {
+    info.ec = ec;
+    return info;
+  }
+  StringRef header = headerOrErr.get()->getBuffer();
+  info.bytesRead = header.size();
+
+  // The slice headers of universal binaries are located at the slice offsets.
+  // Map the file for them, so only the pages holding the headers are read.
+  std::unique_ptr<MemoryBuffer> mappedFile;
+  auto readAt = [&](uint64_t offset, uint64_t size) -> Expected<StringRef> {
+    if (!mappedFile) {
+      auto bufferOrErr = file.getBuffer(path, fileSize,
+                                        /*RequiresNullTerminator=*/false);
+      if (auto ec = bufferOrErr.getError())
+        return errorCodeToError(ec);
+      mappedFile = std::move(bufferOrErr.get());
+    }
+    auto data = mappedFile->getBuffer().substr(offset, size);
+    info.bytesRead += data.size();
+    return data;
+  };
+
+  auto fileType = getMachOFileType(header, fileSize, readAt);
+  if (!fileType)
+    info.error = toString(fileType.takeError());
+  else
+    info.type = fileType.get();
+  return info;
+}
+
+const DirectoryCache::FileInfo &DirectoryCache::addFileInfo(StringRef path,
+                                                            FileInfo info) {
+  numBytesRead += info.bytesRead;
+  return fileInfos.try_emplace(path, std::move(info)).first->second;
+}
+
+void DirectoryCache::prefetch(ArrayRef<std::string> directories,
+                              function_ref<bool(StringRef)> sniffFiles,
+                              unsigned numThreads) {
+  // Walk the trees level by level. All directories of a level are listed in
+  // parallel, followed by the files found in them.
+  std::vector<std::string> pending(directories.begin(), directories.end());
+  while (!pending.empty()) {
+    StringSet<> seen;
+    std::vector<std::string> work;
+    for (auto &directory : pending)
+      if (!listings.count(directory) && seen.insert(directory).second)
+        work.push_back(std::move(directory));
+    pending.clear();
+
+    std::vector<Listing> results(work.size());
+    parallelForEachIndex(work.size(), numThreads,
+                         [&](size_t i) { results[i] = readListing(work[i]); });
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < work.size(); ++i) {
+      bool sniffDirectory = sniffFiles(work[i]);
+      for (const auto &entry : results[i].entries) {
+        if (entry.isSymlink)
+          continue;
+        if (entry.kind == EntryKind::Directory)
+          pending.push_back(entry.path);
+        else if (sniffDirectory && entry.kind == EntryKind::File &&
+                 !isHeaderFile(entry.path) && !fileInfos.count(entry.path))
+          files.push_back(entry.path);
+      }
+      listings.try_emplace(work[i], std::move(results[i]));
+    }
+
+    std::vector<FileInfo> infos(files.size());
+    parallelForEachIndex(files.size(), numThreads,
+                         [&](size_t i) { infos[i] = readFileInfo(files[i]); });
+    for (size_t i = 0; i < files.size(); ++i)
+      addFileInfo(files[i], std::move(infos[i]));
+  }
+}
+
+const DirectoryCache::Listing &DirectoryCache::getListing(StringRef directory) {
+  auto it = listings.find(directory);
+  if (it != listings.end())
+    return it->second;
+  return listings.try_emplace(directory, readListing(directory))
+      .first->second;
+}
+
+const DirectoryCache::FileInfo &DirectoryCache::getFileInfo(StringRef path) {
+  auto it = fileInfos.find(path);
+  if (it != fileInfos.end())
+    return it->second;
+  return addFileInfo(path, readFileInfo(path));
+}
+
 DirectoryScanner::DirectoryScanner(FileManager &fm, DiagnosticsEngine &diag,
                                    ScannerMode mode)
-    : _fm(fm), diag(diag), mode(mode) {
-  _registry.addBinaryReaders();
+    : _fm(fm), diag(diag), ownedCache(std::make_unique<DirectoryCache>(fm)),
+      cache(ownedCache.get()), mode(mode) {}
+
+/// Returns true if \p path is the directory of a framework or of one of its
+/// versions.
+static bool isFrameworkDirectory(StringRef path) {
+  if (path.empty() || path == "/")
+    return false;
+  if (isFramework(path))
+    return true;
+  auto parent = sys::path::parent_path(path);
+  return sys::path::filename(parent) == "Versions" &&
+         isFrameworkDirectory(sys::path::parent_path(parent));
+}
+
+/// Returns true if the scan checks the files in \p directory for dynamic
+/// libraries. Header and module directories are never checked.
+bool DirectoryScanner::isLibraryDirectory(StringRef directory) const {
+  if (!mode.scanBinaries())
+    return false;
+
+  for (StringRef path = directory; !path.empty() && path != "/";
+       path = sys::path::parent_path(path)) {
+    auto name = sys::path::filename(path);
+    auto parent = sys::path::parent_path(path);
+    if ((name == "Headers" || name == "PrivateHeaders" || name == "Modules") &&
+        isFrameworkDirectory(parent))
+      return false;
+    if (name == "include" &&
+        (sys::path::filename(parent) == "usr" ||
+         (sys::path::filename(parent) == "local" &&
+          sys::path::filename(sys::path::parent_path(parent)) == "usr")))
+      return false;
+  }
+
+  return true;
+}
+
+void DirectoryScanner::prefetch(ArrayRef<std::string> directories) const {
+  cache->prefetch(
+      directories,
+      [&](StringRef directory) { return isLibraryDirectory(directory); },
+      numThreads);
 }
 
 std::vector<Framework> DirectoryScanner::takeResult() {
@@ -96,6 +291,13 @@ bool DirectoryScanner::scanDylibDirectory(
     return false;
   }
 
+  std::vector<std::string> headerDirectories;
+  if (directoryEntryPublic)
+    headerDirectories.push_back((*directoryEntryPublic)->getName().str());
+  if (directoryEntryPrivate)
+    headerDirectories.push_back((*directoryEntryPrivate)->getName().str());
+  prefetch(headerDirectories);
+
   auto &dylib = getOrCreateFramework(directory, frameworks);
   dylib.isDynamicLibrary = true;
 
@@ -123,6 +325,7 @@ bool DirectoryScanner::scanDirectory(StringRef directory) {
 
   // Check if the directory is already a framework.
   if (isFramework(directory)) {
+    prefetch(directory.str());
     auto &framework = getOrCreateFramework(directory, frameworks);
     if (!scanFrameworkDirectory(framework, directory))
       return false;
@@ -130,10 +333,15 @@ bool DirectoryScanner::scanDirectory(StringRef directory) {
   }
 
   // Check some known sub-directory locations.
+  std::vector<std::string> paths;
   for (const auto *subDirectory : subDirectories) {
     SmallString<PATH_MAX> path(directory);
     sys::path::append(path, subDirectory);
+    paths.push_back(path.str().str());
+  }
+  prefetch(paths);
 
+  for (const auto &path : paths) {
     if (!scanFrameworksDirectory(frameworks, path))
       return false;
   }
@@ -144,35 +352,31 @@ bool DirectoryScanner::scanDirectory(StringRef directory) {
 /// \brief Scan the directory for frameworks.
 bool DirectoryScanner::scanFrameworksDirectory(
     std::vector<Framework> &frameworks, StringRef directory) const {
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
-  for (vfs::directory_iterator i = fs.dir_begin(directory, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto path = i->path();
+  const auto &listing = cache->getListing(directory);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
+  for (const auto &entry : listing.entries) {
+    StringRef path = entry.path;
 
     // Skip files that not exist. This usually happens for broken symlinks.
-    if (ec == std::errc::no_such_file_or_directory) {
-      ec.clear();
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
-    }
-
-    if (ec) {
-      diag.report(diag::err) << path << ec.message();
-      return false;
-    }
 
-    if (_fm.isSymlink(path))
+    if (entry.isSymlink)
       continue;
 
+    bool isDirectory = entry.kind == DirectoryCache::EntryKind::Directory;
     if (isFramework(path)) {
-      if (!_fm.isDirectory(path, /*CacheFailure=*/false))
+      if (!isDirectory)
         continue;
 
       auto &framework = getOrCreateFramework(path, frameworks);
       if (!scanFrameworkDirectory(framework, path))
         return false;
-    } else if (mode.scanBinaries() &&
-               !_fm.isDirectory(path, /*CacheFailure*/ false)) {
+    } else if (mode.scanBinaries() && !isDirectory) {
       // Check for dynamic libs.
       auto result = isDynamicLibrary(path);
       if (!result) {
@@ -203,30 +407,26 @@ bool DirectoryScanner::scanFrameworkDirectory(Framework &framework,
   // Unfortunately we cannot identify symlinks in the VFS. We assume that if
   // there is a Versions directory, then we have symlinks and directly proceed
   // to the Versiosn folder.
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
 
   // If the framework is inside Kernel or IOKit, scan headers in the different
   // directory separately.
   framework.isDynamicLibrary =
       path.contains("Kernel.framework") || path.contains("IOKit.framework");
 
-  for (vfs::directory_iterator i = fs.dir_begin(path, ec), ie;
-       i != ie; i.increment(ec)) {
-    auto path = i->path();
+  const auto &listing = cache->getListing(path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
+  for (const auto &entry : listing.entries) {
+    StringRef path = entry.path;
 
     // Skip files that not exist. This usually happens for broken symlinks.
-    if (ec == std::errc::no_such_file_or_directory) {
-      ec.clear();
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
-    }
-
-    if (ec) {
-      diag.report(diag::err) << path << ec.message();
-      return false;
-    }
 
-    if (_fm.isSymlink(path))
+    if (entry.isSymlink)
       continue;
 
     StringRef fileName = sys::path::filename(path);
@@ -262,7 +462,7 @@ bool DirectoryScanner::scanFrameworkDirectory(Framework &framework,
     }
 
     // If it is a directory, scan the directory to check for dynamic libs.
-    if (_fm.isDirectory(path, /*CacheFailure=*/false)) {
+    if (entry.kind == DirectoryCache::EntryKind::Directory) {
       if (!scanLibraryDirectory(framework, path))
         return false;
       continue;
@@ -294,14 +494,17 @@ bool DirectoryScanner::scanHeaders(Framework &framework, StringRef path,
   if (!mode.scanPrivateHeaders() && type == HeaderType::Private)
     return true;
 
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
+  const auto &listing = cache->getListing(path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
   std::vector<std::string> subDirectories;
-  for (vfs::directory_iterator i = fs.dir_begin(path, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto headerPath = i->path();
-    if (ec) {
-      diag.report(diag::err) << headerPath << ec.message();
+  for (const auto &entry : listing.entries) {
+    StringRef headerPath = entry.path;
+    if (entry.ec) {
+      diag.report(diag::err) << headerPath << entry.ec.message();
       return false;
     }
 
@@ -310,18 +513,18 @@ bool DirectoryScanner::scanHeaders(Framework &framework, StringRef path,
     if (filename.startswith("."))
       continue;
 
-    if (_fm.isSymlink(headerPath))
+    if (entry.isSymlink)
       continue;
 
     // If it is a directory, remember the subdirectory.
-    if (_fm.isDirectory(headerPath, /*CacheFailure=*/false))
+    if (entry.kind == DirectoryCache::EntryKind::Directory)
       subDirectories.push_back(headerPath.str());
 
     if (!isHeaderFile(headerPath))
       continue;
 
     // Skip files that not exist. This usually happens for broken symlinks.
-    if (fs.status(headerPath) == std::errc::no_such_file_or_directory)
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
 
     auto relativePath =
@@ -353,18 +556,17 @@ bool DirectoryScanner::scanHeaders(Framework &framework, StringRef path,
 
 bool DirectoryScanner::scanModules(Framework &framework,
                                    StringRef _path) const {
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
-  for (vfs::directory_iterator i = fs.dir_begin(_path, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto path = i->path();
-    if (ec) {
-      diag.report(diag::err) << path << ec.message();
-      return false;
-    }
+  const auto &listing = cache->getListing(_path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
+  for (const auto &entry : listing.entries) {
+    StringRef path = entry.path;
 
     // Skip files that not exist. This usually happens for broken symlinks.
-    if (fs.status(path) == std::errc::no_such_file_or_directory)
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
 
     if (path.endswith(".swiftinterface")) {
@@ -391,22 +593,28 @@ bool DirectoryScanner::scanSwiftModules(Framework &framework,
     return false;
 
   framework._swiftModules.emplace_back(path);
-  auto &module = framework._swiftModules.back();
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
-  for (vfs::recursive_directory_iterator i(fs, path, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto f = i->path();
-    if (ec) {
-      diag.report(diag::err) << f << ec.message();
-      return false;
-    }
+  return scanSwiftModuleDirectory(framework._swiftModules.back(), path);
+}
 
-    if (fs.status(f) == std::errc::no_such_file_or_directory)
+bool DirectoryScanner::scanSwiftModuleDirectory(SwiftModule &module,
+                                                StringRef path) const {
+  const auto &listing = cache->getListing(path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
+  for (const auto &entry : listing.entries) {
+    StringRef f = entry.path;
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
 
     if (f.endswith(".swiftinterface") || f.endswith(".swiftmodule"))
       module.addSwiftInterface(f);
+
+    if (entry.kind == DirectoryCache::EntryKind::Directory &&
+        !entry.isSymlink && !scanSwiftModuleDirectory(module, f))
+      return false;
   }
   return true;
 }
@@ -415,28 +623,20 @@ bool DirectoryScanner::scanSwiftModules(Framework &framework,
 /// frameworks.
 bool DirectoryScanner::scanFrameworkVersionsDirectory(Framework &framework,
                                                       StringRef path) const {
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
-  for (vfs::directory_iterator i = fs.dir_begin(path, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto path = i->path();
-
-    // Skip files that not exist. This usually happens for broken symlinks.
-    if (ec == std::errc::no_such_file_or_directory) {
-      ec.clear();
-      continue;
-    }
+  const auto &listing = cache->getListing(path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
 
-    if (ec) {
-      diag.report(diag::err) << path << ec.message();
-      return false;
-    }
+  for (const auto &entry : listing.entries) {
+    StringRef path = entry.path;
 
-    if (_fm.isSymlink(path))
+    if (entry.isSymlink)
       continue;
 
     // Each version is just a framework directory.
-    if (!_fm.isDirectory(path, /*CacheFailure=*/false))
+    if (entry.kind != DirectoryCache::EntryKind::Directory)
       continue;
 
     auto &version = getOrCreateFramework(path, framework._versions);
@@ -449,27 +649,23 @@ bool DirectoryScanner::scanFrameworkVersionsDirectory(Framework &framework,
 
 bool DirectoryScanner::scanLibraryDirectory(Framework &framework,
                                             StringRef path) const {
-  std::error_code ec;
-  auto &fs = _fm.getVirtualFileSystem();
-  for (vfs::directory_iterator i = fs.dir_begin(path, ec), ie; i != ie;
-       i.increment(ec)) {
-    auto path = i->path();
+  const auto &listing = cache->getListing(path);
+  if (listing.ec) {
+    diag.report(diag::err) << listing.errorPath << listing.ec.message();
+    return false;
+  }
+
+  for (const auto &entry : listing.entries) {
+    StringRef path = entry.path;
 
     // Skip files that not exist. This usually happens for broken symlinks.
-    if (ec == std::errc::no_such_file_or_directory) {
-      ec.clear();
+    if (entry.kind == DirectoryCache::EntryKind::Missing)
       continue;
-    }
 
-    if (ec) {
-      diag.report(diag::err) << path << ec.message();
-      return false;
-    }
-
-    if (_fm.isSymlink(path))
+    if (entry.isSymlink)
       continue;
 
-    if (_fm.isDirectory(path, /*CacheFailure=*/false)) {
+    if (entry.kind == DirectoryCache::EntryKind::Directory) {
       scanLibraryDirectory(framework, path);
       continue;
     }
@@ -492,8 +688,8 @@ bool DirectoryScanner::scanLibraryDirectory(Framework &framework,
 }
 
 Expected<bool> DirectoryScanner::isDynamicLibrary(StringRef path) const {
-  auto bufferOrErr = _fm.getBufferForFile(path);
-  if (auto ec = bufferOrErr.getError()) {
+  const auto &info = cache->getFileInfo(path);
+  if (auto ec = info.ec) {
     if (ec == std::errc::permission_denied) {
       diag.report(diag::warn_sdkdb_skip_file) << path << ec.message();
       return false;
@@ -506,15 +702,14 @@ Expected<bool> DirectoryScanner::isDynamicLibrary(StringRef path) const {
   if (path.endswith(".metallib"))
     return false;
 
-  auto fileType = _registry.getFileType(*bufferOrErr.get());
-  if (!fileType)
-    return fileType;
+  if (!info.error.empty())
+    return createStringError(inconvertibleErrorCode(), info.error);
 
-  if (fileType.get() == FileType::MachO_DynamicLibrary ||
-      fileType.get() == FileType::MachO_DynamicLibrary_Stub)
+  if (info.type == FileType::MachO_DynamicLibrary ||
+      info.type == FileType::MachO_DynamicLibrary_Stub)
     return true;
 
-  if (mode.scanBundles() && (fileType.get() == FileType::MachO_Bundle))
+  if (mode.scanBundles() && (info.type == FileType::MachO_Bundle))
     return true;
 
   return false;
@@ -569,6 +764,31 @@ bool DirectoryScanner::scanSDKContent(StringRef directory) {
     return true;
   };
 
+  // Read all the locations scanned below up front, so the file system is
+  // walked in parallel.
+  std::vector<std::string> locations;
+  for (StringRef prefix :
+       {"", MACCATALYST_PREFIX_PATH, DRIVERKIT_PREFIX_PATH, "Library/Apple",
+        CRYPTEXES_PREFIX_PATH, CRYPTEXES_PREFIX_PATH MACCATALYST_PREFIX_PATH}) {
+    SmallString<PATH_MAX> root(rootPath);
+    sys::path::append(root, prefix);
+    if (mode.scanHeaders())
+      locations.push_back(getDirectory("usr/include", root).str().str());
+    if (mode.scanHeaders() && mode.scanPrivateHeaders())
+      locations.push_back(getDirectory("usr/local/include", root).str().str());
+    locations.push_back(getDirectory("usr/lib", root).str().str());
+    locations.push_back(getDirectory("usr/local/lib", root).str().str());
+    if (prefix.empty()) {
+      locations.push_back(getDirectory("System/Library", root).str().str());
+      continue;
+    }
+    locations.push_back(
+        getDirectory("System/Library/Frameworks", root).str().str());
+    locations.push_back(
+        getDirectory("System/Library/PrivateFrameworks", root).str().str());
+  }
+  prefetch(locations);
+
   // Scan SDKRoot.
   if (!scanHeaderAndLibrary(""))
     return false;
@@ -18,14 +18,43 @@ using namespace llvm;
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
+static constexpr StringLiteral globWildcards = "*?";
+
 HeaderGlob::HeaderGlob(StringRef globString, Regex &&regex, HeaderType type)
-    : globString(globString), regex(std::move(regex)), headerType(type) {}
+    : globString(globString), regex(std::move(regex)), headerType(type) {
+  StringRef glob = globString;
+  literalPrefixSize =
+      std::min(glob.find_first_of(globWildcards), glob.size());
+
+  // The literal ends must agree with the regex that decides the match.
+  // createRegexFromGlob doesn't emit the character that follows a run of
+  // '*', so that character isn't part of the literal suffix either.
+  size_t suffixStart = 0;
+  for (size_t i = 0; i < glob.size(); ++i) {
+    if (glob[i] == '?') {
+      suffixStart = i + 1;
+      continue;
+    }
+    if (glob[i] != '*')
+      continue;
+    while (i < glob.size() && glob[i] == '*')
+      ++i;
+    suffixStart = i + 1;
+  }
+  literalSuffixSize = glob.size() - std::min(suffixStart, glob.size());
+}
 
 bool HeaderGlob::match(const HeaderFile &header) {
   if (header.type != headerType)
     return false;
 
-  bool result = regex.match(header.fullPath);
+  // The literal ends are much cheaper to compare than running the regex.
+  StringRef path = header.fullPath;
+  if (!path.startswith(getLiteralPrefix()) ||
+      !path.endswith(getLiteralSuffix()))
+    return false;
+
+  bool result = regex.match(path);
   if (result)
     foundMatch = true;
   return result;
@@ -40,4 +69,38 @@ Expected<std::unique_ptr<HeaderGlob>> HeaderGlob::create(StringRef globString,
   return std::make_unique<HeaderGlob>(globString, std::move(*regex), type);
 }
 
+/// Returns the text after the last path separator.
+static StringRef getFileName(StringRef path) {
+  return path.drop_front(path.rfind('/') + 1);
+}
+
+void HeaderGlobSet::add(std::unique_ptr<HeaderGlob> glob) {
+  // Every header the glob matches ends with the literal suffix, so its file
+  // name ends with the part of the suffix after the last path separator. For
+  // example, both '**/Foo.h' and 'Dir/*/Foo.h' are indexed by 'Foo.h'.
+  auto key = getFileName(glob->getLiteralSuffix());
+  if (!key.empty())
+    globsByFileNameSuffix[key].push_back(glob.get());
+  else
+    unindexedGlobs.push_back(glob.get());
+  list.emplace_back(std::move(glob));
+}
+
+bool HeaderGlobSet::match(const HeaderFile &header) {
+  bool result = false;
+  StringRef fileName = getFileName(header.fullPath);
+  for (size_t i = 0; i < fileName.size(); ++i) {
+    auto it = globsByFileNameSuffix.find(fileName.drop_front(i));
+    if (it == globsByFileNameSuffix.end())
+      continue;
+    for (auto *glob : it->second)
+      result |= glob->match(header);
+  }
+
+  for (auto *glob : unindexedGlobs)
+    result |= glob->match(header);
+
+  return result;
+}
+
 TAPI_NAMESPACE_INTERNAL_END
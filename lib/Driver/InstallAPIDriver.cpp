@@ -851,13 +851,13 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
     }
   }
 
-  std::vector<std::unique_ptr<HeaderGlob>> excludeHeaderGlobs;
+  HeaderGlobSet excludeHeaderGlobs;
   std::set<const FileEntry *> excludeHeaderFiles;
   auto parseGlobs = [&](const PathSeq &paths, HeaderType type) {
     for (const auto &str : paths) {
       auto glob = HeaderGlob::create(str, type);
       if (glob)
-        excludeHeaderGlobs.emplace_back(std::move(glob.get()));
+        excludeHeaderGlobs.add(std::move(glob.get()));
       else {
         consumeError(glob.takeError());
         if (auto file = fm.getFile(str))
@@ -881,9 +881,8 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
     return false;
 
   for (auto &header : headerFiles) {
-    for (auto &glob : excludeHeaderGlobs)
-      if (glob->match(header))
-        header.isExcluded = true;
+    if (excludeHeaderGlobs.match(header))
+      header.isExcluded = true;
   }
 
   if (!excludeHeaderFiles.empty()) {
@@ -896,7 +895,7 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
     }
   }
 
-  for (const auto &glob : excludeHeaderGlobs)
+  for (const auto &glob : excludeHeaderGlobs.globs())
     if (!glob->didMatch())
       diag.report(diag::warn_glob_did_not_match) << glob->str();
 
@@ -1268,10 +1267,17 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
     result.api->visit(normalizer);
   }
 
-  if (auto err = PartialSDKDB::serialize(
-          fs, /*omit name*/ "", std::vector<API>(),
-          std::vector<FrontendContext>(), std::vector<API>(), frontendResults,
-          std::vector<API>(), /*hasError*/ false)) {
+  auto err =
+      opts.tapiOptions.sdkdbBinaryFormat
+          ? PartialSDKDB::serializeBinary(
+                fs, /*omit name*/ "", std::vector<API>(),
+                std::vector<FrontendContext>(), std::vector<API>(),
+                frontendResults, std::vector<API>(), /*hasError*/ false)
+          : PartialSDKDB::serialize(
+                fs, /*omit name*/ "", std::vector<API>(),
+                std::vector<FrontendContext>(), std::vector<API>(),
+                frontendResults, std::vector<API>(), /*hasError*/ false);
+  if (err) {
     diag.report(diag::err_cannot_generate_sdkdb) << toString(std::move(err));
     return false;
   }
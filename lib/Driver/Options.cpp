@@ -568,6 +568,15 @@ bool Options::processDriverOptions(DiagnosticsEngine &diag,
     driverOptions.clangExecutablePath = getClangExecutablePath();
   }
 
+  // Handle parallel jobs.
+  if (auto *arg = args.getLastArg(OPT_j)) {
+    if (StringRef(arg->getValue()).getAsInteger(10, driverOptions.numThreads)) {
+      diag.report(clang::diag::err_drv_invalid_int_value)
+          << arg->getAsString(args) << arg->getValue();
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -1383,6 +1392,17 @@ bool Options::processTAPIOptions(DiagnosticsEngine &diag, InputArgList &args) {
     }
   }
 
+  if (auto *arg = args.getLastArg(OPT_sdkdb_output_format)) {
+    StringRef format = arg->getValue();
+    if (format == "binary")
+      tapiOptions.sdkdbBinaryFormat = true;
+    else if (format != "json") {
+      diag.report(clang::diag::err_drv_invalid_value)
+          << arg->getAsString(args) << format;
+      return false;
+    }
+  }
+
   // Handle previously ignored, but invalid options.
   for (auto *arg :
        args.filtered(OPT_log, OPT_fvisibility_inlines, OPT_l, OPT_framework,
@@ -48,6 +48,7 @@
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/TextAPI/ArchitectureSet.h"
+#include <atomic>
 #include <system_error>
 
 using namespace llvm;
@@ -115,6 +116,7 @@ public:
   PathSeq systemFrameworkPaths;
   PathSeq afterIncludePaths;
   bool verbose;
+  unsigned numThreads;
   PlatformType platform{PLATFORM_UNKNOWN};
   std::string version;
   bool verifyAPI;
@@ -140,6 +142,7 @@ public:
     action = opt.sdkdbOptions.action;
     diagnosticsFile = opt.sdkdbOptions.diagnosticsFile;
     verbose = opt.frontendOptions.verbose;
+    numThreads = opt.driverOptions.numThreads;
     verifyAPI = opt.tapiOptions.verifyAPI;
     verifyAPISkipExternalHeaders = opt.tapiOptions.verifyAPISkipExternalHeaders;
 
@@ -186,13 +189,14 @@ public:
     return true;
   }
 
-  Error scanBinaryFile(StringRef path, std::vector<Triple> &triples,
-                       bool isPublic) {
+  /// Read the APIs from a binary. This only reads shared state and is safe to
+  /// call from the framework scan workers.
+  Expected<MachOParseResult> readBinaryFile(StringRef path) const {
     if (!_fm->exists(path))
       return make_error<StringError>(
           "binary file doesn't exist", inconvertibleErrorCode());
 
-    auto bufferOrErr = _fm->getBufferForFile(path);
+    auto bufferOrErr = _fm->getVirtualFileSystem().getBufferForFile(path);
     if (auto ec = bufferOrErr.getError())
       return errorCodeToError(ec);
 
@@ -200,30 +204,37 @@ public:
     option.arches = config.getArchitectures();
     // Do not include undefined (external linkage) symbols in MachO.
     option.parseUndefined = false;
+    // This runs on the framework scan workers, so read the slices serially.
+    option.numThreads = 1;
     auto results = readMachOFile(bufferOrErr->get()->getMemBufferRef(), option);
     if (!results)
       return results.takeError();
 
+    // Update all interfaces to public if configuration suggests.
     for (auto &result : *results) {
-      const auto &target = result.second->getTriple();
-      if (std::find(triples.begin(), triples.end(), target) ==
-          std::end(triples))
-        triples.push_back(target);
-
-      // Update all interfaces to public if configuration suggests.
       if (config.isPromotedToPublicDylib(
               result.second->getBinaryInfo().installName)) {
         APIPromoter promoter;
         result.second->visit(promoter);
       }
+    }
+
+    return results;
+  }
+
+  void addBinaryResults(MachOParseResult &results,
+                        std::vector<Triple> &triples, bool isPublic) {
+    for (auto &result : results) {
+      const auto &target = result.second->getTriple();
+      if (std::find(triples.begin(), triples.end(), target) ==
+          std::end(triples))
+        triples.push_back(target);
 
       if (isPublic)
         publicBinaryResults.emplace_back(std::move(*result.second));
       else
         internalBinaryResults.emplace_back(std::move(*result.second));
     }
-
-    return Error::success();
   }
 
   Error performOutput(StringRef path,
@@ -331,6 +342,45 @@ private:
   API &api;
 };
 
+/// A single clang invocation of the header scan. The jobs are fully configured
+/// up front, so the invocations can run in any order.
+struct FrontendInvocation {
+  FrontendJob job;
+  std::optional<FrontendContext> result;
+  bool failed = false;
+  /// The clang diagnostics and notes of the job, replayed in scan order.
+  std::string output;
+
+  FrontendInvocation(const FrontendJob &job) : job(job) {}
+};
+
+/// The scan state of a single framework (without its sub-frameworks and
+/// versions). Binaries and headers are processed on the worker pool and the
+/// results are merged back in the serial scan order.
+struct FrameworkScan {
+  Framework *framework;
+  std::vector<Expected<MachOParseResult>> binaries;
+  std::vector<Triple> triples;
+  std::vector<FrontendInvocation> invocations;
+  bool failed = false;
+
+  FrameworkScan(Framework &framework) : framework(&framework) {}
+};
+
+/// A partial SDKDB found in the output directory. The files are read and
+/// parsed on the worker pool and merged back in sorted path order.
+struct PartialSDKDBFile {
+  std::string path;
+  bool isSwiftSDKDB;
+  // Not set if the file couldn't be read. The private result is only set if
+  // the public result could be created.
+  std::optional<Expected<PartialSDKDB>> publicResult;
+  std::optional<Expected<PartialSDKDB>> privateResult;
+
+  PartialSDKDBFile(StringRef path)
+      : path(path.str()), isSwiftSDKDB(path.ends_with(".swift.sdkdb")) {}
+};
+
 } // namespace sdkdb
 
 namespace {
@@ -436,9 +486,13 @@ static void inferTriplesFromEnvironment(sdkdb::Context &context,
   }
 }
 
-static bool computeFrontendResultFromFramework(
+/// Configure the frontend jobs for the framework headers. This only sets up
+/// the clang invocations in \p invocations, running them is left to the
+/// caller.
+static bool prepareFrontendInvocations(
     sdkdb::Context &context, const Framework &framework,
     std::vector<Triple> &triples,
+    std::vector<sdkdb::FrontendInvocation> &invocations,
     // isPublic is used to indicate scanning the public SDK content root.
     // it prefers the public SDK root and sets the public SDK overlay.
     // publicOnly only controls the type of headers for scanning and skips
@@ -521,13 +575,13 @@ static bool computeFrontendResultFromFramework(
 
   // Create the excluded headers list.
   std::set<const FileEntry *> excludeHeaderFiles;
-  std::vector<std::unique_ptr<HeaderGlob>> excludeHeaderGlobs;
+  HeaderGlobSet excludeHeaderGlobs;
   auto parseGlobs = [&](HeaderType type) {
     for (const auto &str :
          context.config.getExcludedHeaders(frameworkPath, type)) {
       auto glob = HeaderGlob::create(str, type);
       if (glob)
-        excludeHeaderGlobs.emplace_back(std::move(glob.get()));
+        excludeHeaderGlobs.add(std::move(glob.get()));
       else {
         consumeError(glob.takeError());
         if (auto file = fm.getFile(str))
@@ -565,9 +619,8 @@ static bool computeFrontendResultFromFramework(
       if (glob->match(header))
         header.isExcluded = true;
 
-    for (auto &glob : excludeHeaderGlobs)
-      if (glob->match(header))
-        header.isExcluded = true;
+    if (excludeHeaderGlobs.match(header))
+      header.isExcluded = true;
   }
 
   if (!excludeHeaderFiles.empty()) {
@@ -580,7 +633,7 @@ static bool computeFrontendResultFromFramework(
     }
   }
 
-  for (const auto &glob : excludeHeaderGlobs)
+  for (const auto &glob : excludeHeaderGlobs.globs())
     if (!glob->didMatch())
       diag.report(diag::warn_glob_did_not_match) << glob->str();
 
@@ -732,13 +785,10 @@ static bool computeFrontendResultFromFramework(
     job->vfs = overlay;
   }
 
-  auto &output =
-      isPublic ? context.publicSDKResults : context.internalSDKResults;
   for (auto type : {HeaderType::Public, HeaderType::Private}) {
     if (publicOnly && type == HeaderType::Private)
       continue;
 
-    std::vector<FrontendContext> results;
     for (auto &target : triples) {
       job->target = target;
       job->type = type;
@@ -770,15 +820,40 @@ static bool computeFrontendResultFromFramework(
       }
       job->createClangReproducer = true;
 
-      auto contextOrError = runFrontend(*job);
-      if (auto err = contextOrError.takeError()) {
-        if (canIgnoreFrontendError(err))
-          continue;
-        return false;
-      }
+      // Take a snapshot of the job for this target. The frontend binds the
+      // symbol verifier to the source manager of the run, so every invocation
+      // needs its own.
+      invocations.emplace_back(*job);
+      invocations.back().job.verifier =
+          std::make_shared<SymbolVerifier>(SymbolVerifier());
+    }
+  }
 
-      results.emplace_back(std::move(*contextOrError));
+  return true;
+}
+
+/// Collect the frontend results of a framework in the order the serial scan
+/// produced them, and run the API verifier on zippered results.
+static bool
+mergeFrontendResults(sdkdb::Context &context,
+                     std::vector<sdkdb::FrontendInvocation> &invocations,
+                     bool isPublic) {
+  auto &diag = context.getDiag();
+  auto &output =
+      isPublic ? context.publicSDKResults : context.internalSDKResults;
+  auto it = invocations.begin();
+  while (it != invocations.end()) {
+    // All invocations for the same header type are adjacent.
+    auto type = it->job.type;
+    std::vector<FrontendContext> results;
+    for (; it != invocations.end() && it->job.type == type; ++it) {
+      errs() << it->output;
+      if (it->failed)
+        return false;
+      if (it->result)
+        results.emplace_back(std::move(*it->result));
     }
+
     if (context.verifyAPI && results.size() == 2) {
       auto &api1 = results.front();
       auto &api2 = results.back();
@@ -824,55 +899,133 @@ static Expected<API> createAPIsFromSwiftAPIJson(llvm::json::Object &input) {
     return result.takeError();
 }
 
+/// Collect the frameworks to scan in dependency order: sub-frameworks first,
+/// then versions, then the framework itself.
+static void collectFrameworks(Framework &framework, bool publicOnly,
+                              std::vector<sdkdb::FrameworkScan> &scans) {
+  if (publicOnly && framework.getPath().contains("PrivateFrameworks"))
+    return;
+
+  for (auto &F : framework._subFrameworks)
+    collectFrameworks(F, publicOnly, scans);
+
+  for (auto &F : framework._versions)
+    collectFrameworks(F, publicOnly, scans);
+
+  scans.emplace_back(framework);
+}
+
 static Error scanFramework(sdkdb::Context &context, Framework &framework,
                            bool isPublic, bool binaryOnly,
                            bool publicOnly = false) {
-  if (publicOnly && framework.getPath().contains("PrivateFrameworks"))
-    return Error::success();
+  std::vector<sdkdb::FrameworkScan> scans;
+  collectFrameworks(framework, publicOnly, scans);
 
   //
-  // First scan all sub-frameworks, because we most likely will depend on them.
+  // First read all the framework binaries. A framework stops at its first
+  // unreadable binary, like the serial scan did.
   //
-  for (auto &F : framework._subFrameworks) {
-    if (auto err = scanFramework(context, F, isPublic, binaryOnly, publicOnly))
-      return err;
+  parallelForEachIndex(scans.size(), context.numThreads, [&](size_t i) {
+    auto &scan = scans[i];
+    for (const auto &path : scan.framework->_dynamicLibraryFiles) {
+      scan.binaries.emplace_back(context.readBinaryFile(path));
+      if (!scan.binaries.back())
+        break;
+    }
+  });
+
+  // Record the binary results in scan order. Everything after the first error
+  // is dropped, but all results still need to be checked.
+  Error binaryError = Error::success();
+  size_t numScanned = 0;
+  for (auto &scan : scans) {
+    for (auto &result : scan.binaries) {
+      if (!result) {
+        if (binaryError)
+          consumeError(result.takeError());
+        else
+          binaryError = result.takeError();
+        continue;
+      }
+      if (!binaryError)
+        context.addBinaryResults(*result, scan.triples, isPublic);
+    }
+    if (!binaryError)
+      ++numScanned;
   }
+  scans.erase(scans.begin() + numScanned, scans.end());
+
+  if (binaryOnly)
+    return binaryError;
 
   //
-  // Second scan all versions ...
+  // Now configure the header scan of every framework, serially, because it
+  // uses the file manager and reports diagnostics.
   //
-  for (auto &F : framework._versions) {
-    if (auto err = scanFramework(context, F, isPublic, binaryOnly, publicOnly))
-      return err;
+  for (auto &scan : scans) {
+    // If there are no binaries, guess the triple from environment.
+    if (scan.triples.empty())
+      inferTriplesFromEnvironment(context, *scan.framework, scan.triples);
+
+    scan.failed = !prepareFrontendInvocations(context, *scan.framework,
+                                              scan.triples, scan.invocations,
+                                              isPublic, publicOnly);
   }
 
   //
-  // Now scan the framework binary.
+  // Run all the frontend jobs on the worker pool.
   //
-  std::vector<Triple> triples;
-  for (const auto &path : framework._dynamicLibraryFiles) {
-    if (auto err = context.scanBinaryFile(path, triples, isPublic))
-      return err;
+  // The output of every job is buffered and replayed in scan order when the
+  // results are merged. Clang prints part of its -v output directly to
+  // stderr, so verbose runs stay serial and unbuffered.
+  std::vector<std::pair<sdkdb::FrontendInvocation *, size_t>> invocations;
+  for (size_t i = 0; i < scans.size(); ++i) {
+    if (scans[i].failed)
+      continue;
+    for (auto &invocation : scans[i].invocations)
+      invocations.emplace_back(&invocation, i);
   }
 
-  if (binaryOnly)
-    return Error::success();
+  // A framework stops at its first failed job like the serial scan. Jobs are
+  // handed out in order, so a skipped job always follows the failed one.
+  std::vector<std::atomic<bool>> hasFrontendError(scans.size());
+  unsigned numThreads = context.verbose ? 1 : context.numThreads;
+  parallelForEachIndex(invocations.size(), numThreads, [&](size_t i) {
+    auto &[invocation, scanIndex] = invocations[i];
+    if (hasFrontendError[scanIndex])
+      return;
 
-  // If there are no binaries, guess the triple from environment.
-  if (triples.empty())
-    inferTriplesFromEnvironment(context, framework, triples);
+    raw_string_ostream os(invocation->output);
+    if (!context.verbose)
+      invocation->job.diagnosticOutput = &os;
+    auto contextOrError = runFrontend(invocation->job);
+    invocation->job.diagnosticOutput = nullptr;
+    os.flush();
+    if (auto err = contextOrError.takeError()) {
+      invocation->failed = !canIgnoreFrontendError(err);
+      if (invocation->failed)
+        hasFrontendError[scanIndex] = true;
+      return;
+    }
+    invocation->result.emplace(std::move(*contextOrError));
+  });
 
-  // Now scan the header files.
-  if (!computeFrontendResultFromFramework(context, framework, triples,
-        isPublic, publicOnly)) {
-    if (!context.hasSDKDBError) {
-      context.hasSDKDBError = true;
-      context.getDiag().report(diag::err_cannot_generate_sdkdb)
-          << "Failed to scan header interface";
+  //
+  // Merge the header results in scan order. A failed framework doesn't affect
+  // the frameworks that follow it; the error is only reported once.
+  //
+  for (auto &scan : scans) {
+    if (scan.failed ||
+        !mergeFrontendResults(context, scan.invocations, isPublic)) {
+      if (!context.hasSDKDBError) {
+        context.hasSDKDBError = true;
+        context.getDiag().report(diag::err_cannot_generate_sdkdb)
+            << "Failed to scan header interface";
+      }
     }
   }
 
-  return Error::success();
+  return binaryError;
 }
 
 static bool interfaceScan(sdkdb::Context &context, Options &opts) {
@@ -956,6 +1109,9 @@ static bool interfaceScan(sdkdb::Context &context, Options &opts) {
 
   // Scan roots and setup VFS overlays.
   std::vector<Framework> publicFrameworks, internalFrameworks;
+  // Both scans read the runtime root and possibly the same SDK content root,
+  // so they share the directory listings and sniffed file types.
+  DirectoryCache directoryCache(context.getFileManager());
 
   // Scan PublicSDKContentRoot.
   if (config.scanPublicHeaders && !context.config.scanPublicHeadersInSDKContentRoot()) {
@@ -963,6 +1119,8 @@ static bool interfaceScan(sdkdb::Context &context, Options &opts) {
                              ScannerMode::ScanRuntimeRoot);
     // Scan binary first.
     scanner.setSplitHeaderDir(context.config.useSplitHeaderDir());
+    scanner.setNumThreads(context.numThreads);
+    scanner.setDirectoryCache(directoryCache);
     if (!scanner.scan(opts.sdkdbOptions.runtimeRoot))
       return false;
 
@@ -991,6 +1149,8 @@ static bool interfaceScan(sdkdb::Context &context, Options &opts) {
     DirectoryScanner scanner(context.getFileManager(), diag,
                              ScannerMode::ScanRuntimeRoot);
     scanner.setSplitHeaderDir(context.config.useSplitHeaderDir());
+    scanner.setNumThreads(context.numThreads);
+    scanner.setDirectoryCache(directoryCache);
     if (!scanner.scan(opts.sdkdbOptions.runtimeRoot))
       return false;
 
@@ -1010,6 +1170,11 @@ static bool interfaceScan(sdkdb::Context &context, Options &opts) {
            "There should be only one top level framework");
   }
 
+  if (context.verbose)
+    errs() << "read " << directoryCache.getNumBytesRead()
+           << " bytes to determine the type of "
+           << directoryCache.getNumFilesRead() << " files\n";
+
   // Scan frameworks.
   if (config.scanPublicHeaders && !context.config.scanPublicHeadersInSDKContentRoot()) {
     auto rootPath = opts.sdkdbOptions.publicSDKContentRoot.empty()
@@ -1081,36 +1246,51 @@ static bool writePartialSDKDB(sdkdb::Context &context) {
   return true;
 }
 
-static Error parsePartialSDKDB(sdkdb::Context &context, StringRef JSON) {
-  auto inputValue = json::parse(JSON);
-  if (!inputValue)
-    return inputValue.takeError();
-
-  auto *root = inputValue->getAsObject();
-  if (!root)
-    return make_error<APIJSONError>("API is not a JSON Object");
+static Error parsePartialSDKDB(sdkdb::Context &context, StringRef buffer) {
+  const bool publicGen = context.action & SDKDBAction::SDKDBPublicGen;
+  const bool privateGen = context.action & SDKDBAction::SDKDBPrivateGen;
+  PartialSDKDB publicResult;
+  PartialSDKDB privateResult;
+
+  // Binary partial SDKDBs are decoded once for both outputs.
+  if (PartialSDKDB::isBinaryFormat(buffer)) {
+    if (auto err = PartialSDKDB::createAPIsFromBinary(
+            buffer, publicGen ? &publicResult : nullptr,
+            privateGen ? &privateResult : nullptr))
+      return err;
+  } else {
+    auto inputValue = json::parse(buffer);
+    if (!inputValue)
+      return inputValue.takeError();
 
-  if (context.action & SDKDBAction::SDKDBPublicGen) {
-    auto partialResult = PartialSDKDB::createPublicAPIsFromJSON(*root);
-    if (!partialResult)
-      return partialResult.takeError();
+    auto *root = inputValue->getAsObject();
+    if (!root)
+      return make_error<APIJSONError>("API is not a JSON Object");
+
+    if (publicGen) {
+      auto partialResult = PartialSDKDB::createPublicAPIsFromJSON(*root);
+      if (!partialResult)
+        return partialResult.takeError();
+      publicResult = std::move(*partialResult);
+    }
 
-    for (auto &result : partialResult->binaryInterfaces)
-      context.publicBinaryResults.emplace_back(std::move(result));
-    for (auto &result : partialResult->headerInterfaces)
-      context.extraPublicSDKResults.emplace_back(std::move(result));
+    if (privateGen) {
+      auto partialResult = PartialSDKDB::createPrivateAPIsFromJSON(*root);
+      if (!partialResult)
+        return partialResult.takeError();
+      privateResult = std::move(*partialResult);
+    }
   }
 
-  if (context.action & SDKDBAction::SDKDBPrivateGen) {
-    auto partialResult = PartialSDKDB::createPrivateAPIsFromJSON(*root);
-    if (!partialResult)
-      return partialResult.takeError();
+  for (auto &result : publicResult.binaryInterfaces)
+    context.publicBinaryResults.emplace_back(std::move(result));
+  for (auto &result : publicResult.headerInterfaces)
+    context.extraPublicSDKResults.emplace_back(std::move(result));
 
-    for (auto &result : partialResult->binaryInterfaces)
-      context.internalBinaryResults.emplace_back(std::move(result));
-    for (auto &result : partialResult->headerInterfaces)
-      context.extraInternalSDKResults.emplace_back(std::move(result));
-  }
+  for (auto &result : privateResult.binaryInterfaces)
+    context.internalBinaryResults.emplace_back(std::move(result));
+  for (auto &result : privateResult.headerInterfaces)
+    context.extraInternalSDKResults.emplace_back(std::move(result));
 
   return Error::success();
 }
@@ -1181,6 +1361,81 @@ static bool readPartialSDKDBInputs(sdkdb::Context &context, Options &opts) {
   return true;
 }
 
+/// Wrap the API of a Swift SDKDB into a partial SDKDB with a single header
+/// interface.
+static Expected<PartialSDKDB>
+createPartialSDKDBFromSwiftAPIJson(StringRef path, json::Object &input) {
+  auto api = createAPIsFromSwiftAPIJson(input);
+  if (!api)
+    return makeSwiftSDKDBError(path, api.takeError());
+
+  PartialSDKDB result;
+  result.headerInterfaces.emplace_back(std::move(*api));
+  return std::move(result);
+}
+
+/// Read and parse a single partial SDKDB. This runs on the worker pool, so it
+/// only uses the virtual file system and doesn't report diagnostics. Regular
+/// partial SDKDBs that can't be read or parsed are skipped.
+static void loadPartialSDKDBFile(vfs::FileSystem &fs,
+                                 sdkdb::PartialSDKDBFile &file) {
+  const auto &path = file.path;
+  auto buffer = fs.getBufferForFile(path);
+  if (!buffer) {
+    if (file.isSwiftSDKDB)
+      file.publicResult.emplace(makeSwiftSDKDBError(path, buffer.getError()));
+    return;
+  }
+
+  // Binary partial SDKDBs are read directly, without a JSON DOM, and decoded
+  // once for both the public and the private APIs.
+  StringRef content = (*buffer)->getBuffer();
+  if (!file.isSwiftSDKDB && PartialSDKDB::isBinaryFormat(content)) {
+    PartialSDKDB publicResult;
+    PartialSDKDB privateResult;
+    if (auto err = PartialSDKDB::createAPIsFromBinary(content, &publicResult,
+                                                      &privateResult)) {
+      file.publicResult.emplace(std::move(err));
+      return;
+    }
+    file.publicResult.emplace(std::move(publicResult));
+    file.privateResult.emplace(std::move(privateResult));
+    return;
+  }
+
+  // Parse the JSON once and build both the public and the private APIs from
+  // it.
+  auto inputValue = json::parse(content);
+  if (!inputValue) {
+    if (file.isSwiftSDKDB)
+      file.publicResult.emplace(
+          makeSwiftSDKDBError(path, inputValue.takeError()));
+    else
+      consumeError(inputValue.takeError());
+    return;
+  }
+
+  auto *root = inputValue->getAsObject();
+  if (!root) {
+    if (file.isSwiftSDKDB)
+      file.publicResult.emplace(
+          makeSwiftSDKDBError(path, "Invalid JSON object"));
+    return;
+  }
+
+  if (file.isSwiftSDKDB) {
+    file.publicResult.emplace(createPartialSDKDBFromSwiftAPIJson(path, *root));
+    if (*file.publicResult)
+      file.privateResult.emplace(
+          createPartialSDKDBFromSwiftAPIJson(path, *root));
+    return;
+  }
+
+  file.publicResult.emplace(PartialSDKDB::createPublicAPIsFromJSON(*root));
+  if (*file.publicResult)
+    file.privateResult.emplace(PartialSDKDB::createPrivateAPIsFromJSON(*root));
+}
+
 static Error readExistingPartialSDKDBFromDirectory(sdkdb::Context &context) {
   // Skip if no output is specified or output is stdout.
   if (context.installAPISDKDBPath.empty())
@@ -1220,80 +1475,53 @@ static Error readExistingPartialSDKDBFromDirectory(sdkdb::Context &context) {
   // traverse order of the file system.
   llvm::sort(inputFiles);
 
-  for (auto &path : inputFiles) {
-    const bool isSwiftSDKDB = StringRef(path).ends_with(".swift.sdkdb");
+  std::vector<sdkdb::PartialSDKDBFile> files;
+  files.reserve(inputFiles.size());
+  for (const auto &path : inputFiles)
+    files.emplace_back(path);
+
+  parallelForEachIndex(files.size(), context.numThreads, [&](size_t i) {
+    loadPartialSDKDBFile(fs, files[i]);
+  });
+
+  // Merge the results in sorted path order. The first Swift SDKDB error stops
+  // the merge, but all results still need to be checked.
+  Error swiftError = Error::success();
+  auto isUsable = [&](sdkdb::PartialSDKDBFile &file,
+                      Expected<PartialSDKDB> &result) {
+    if (result)
+      return !swiftError;
+    if (file.isSwiftSDKDB && !swiftError)
+      swiftError = result.takeError();
+    else
+      consumeError(result.takeError());
+    return false;
+  };
 
-    // Read partial SDKDB output.
-    auto file = context.getFileManager().getFile(path);
-    if (!file) {
-      if (isSwiftSDKDB)
-        return makeSwiftSDKDBError(path, file.getError());
-      continue;
-    }
-    auto buffer = context.getFileManager().getBufferForFile(*file);
-    if (!buffer) {
-      if (isSwiftSDKDB)
-        return makeSwiftSDKDBError(path, buffer.getError());
+  for (auto &file : files) {
+    // Check both results before merging either of them, so that no error is
+    // left unchecked when the public result is skipped.
+    bool publicUsable = file.publicResult && isUsable(file, *file.publicResult);
+    bool privateUsable =
+        file.privateResult && isUsable(file, *file.privateResult);
+    if (!publicUsable)
       continue;
-    }
 
-    auto inputValue = json::parse((*buffer)->getBuffer());
-    if (!inputValue) {
-      if (isSwiftSDKDB)
-        return makeSwiftSDKDBError(path, inputValue.takeError());
-      consumeError(inputValue.takeError());
-      continue;
-    }
+    for (auto &result : (*file.publicResult)->binaryInterfaces)
+      context.publicBinaryResults.emplace_back(std::move(result));
+    for (auto &result : (*file.publicResult)->headerInterfaces)
+      context.extraPublicSDKResults.emplace_back(std::move(result));
 
-    auto *root = inputValue->getAsObject();
-    if (!root) {
-      if (isSwiftSDKDB)
-        return makeSwiftSDKDBError(path, "Invalid JSON object");
+    if (!privateUsable)
       continue;
-    }
-
-    if (isSwiftSDKDB) {
-      auto publicResult = createAPIsFromSwiftAPIJson(*root);
-      if (!publicResult)
-        return makeSwiftSDKDBError(path, publicResult.takeError());
-
-      context.extraPublicSDKResults.emplace_back(std::move(*publicResult));
-
-      auto internalResult = createAPIsFromSwiftAPIJson(*root);
-      if (!internalResult)
-        return makeSwiftSDKDBError(path, internalResult.takeError());
-
-      context.extraInternalSDKResults.emplace_back(std::move(*internalResult));
-    } else {
-      {
-        auto partialResult = PartialSDKDB::createPublicAPIsFromJSON(*root);
-        if (!partialResult) {
-          consumeError(partialResult.takeError());
-          continue;
-        }
 
-        for (auto &result : partialResult->binaryInterfaces)
-          context.publicBinaryResults.emplace_back(std::move(result));
-        for (auto &result : partialResult->headerInterfaces)
-          context.extraPublicSDKResults.emplace_back(std::move(result));
-      }
-
-      {
-        auto partialResult = PartialSDKDB::createPrivateAPIsFromJSON(*root);
-        if (!partialResult) {
-          consumeError(partialResult.takeError());
-          continue;
-        }
-
-        for (auto &result : partialResult->binaryInterfaces)
-          context.internalBinaryResults.emplace_back(std::move(result));
-        for (auto &result : partialResult->headerInterfaces)
-          context.extraInternalSDKResults.emplace_back(std::move(result));
-      }
-    }
+    for (auto &result : (*file.privateResult)->binaryInterfaces)
+      context.internalBinaryResults.emplace_back(std::move(result));
+    for (auto &result : (*file.privateResult)->headerInterfaces)
+      context.extraInternalSDKResults.emplace_back(std::move(result));
   }
 
-  return Error::success();
+  return swiftError;
 }
 
 /// Scan the directory for header and dynamic libraries and generate
@@ -1390,6 +1618,7 @@ static bool runSDKDBDriver(sdkdb::Context &context, DiagnosticsEngine &diag,
   if (opts.sdkdbOptions.action & SDKDBAction::SDKDBPublicGen) {
     SDKDBBuilderOptions options = SDKDBBuilderOptions::isPublicOnly;
     SDKDBBuilder builder(diag, options);
+    builder.setNumThreads(context.numThreads);
     for (auto &api : context.publicBinaryResults) {
       if (auto err = builder.addBinaryAPI(std::move(api)))
         diag.report(diag::err_cannot_generate_sdkdb)
@@ -1426,6 +1655,7 @@ static bool runSDKDBDriver(sdkdb::Context &context, DiagnosticsEngine &diag,
 
   if (opts.sdkdbOptions.action & SDKDBAction::SDKDBPrivateGen) {
     SDKDBBuilder builder(diag);
+    builder.setNumThreads(context.numThreads);
     for (auto &api : context.internalBinaryResults) {
       if (auto err = builder.addBinaryAPI(std::move(api)))
         diag.report(diag::err_cannot_generate_sdkdb)
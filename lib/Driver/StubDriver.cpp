@@ -25,7 +25,10 @@
 #include "clang/Driver/DriverDiagnostic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/TextAPI/InterfaceFile.h"
+#include <atomic>
+#include <optional>
 #include <queue>
 #include <string>
 
@@ -56,6 +59,7 @@ struct Context {
   bool deletePrivateFrameworks = false;
   bool traceLibraryLocation = false;
   bool removeSharedCacheFlag = false;
+  unsigned numThreads = 0;
 
 
   PathSeq sysroots;
@@ -288,6 +292,37 @@ static bool stubifyDynamicLibrary(Context &ctx) {
   return true;
 }
 
+/// \brief Reads the dynamic library or text-based stub file at \p path.
+/// Returns nullptr for all other files. Only uses the VFS and the registry, so
+/// it is safe to call from multiple threads.
+static Expected<std::unique_ptr<InterfaceFile>>
+readLibraryFile(Context &ctx, StringRef path) {
+  auto bufferOrErr = ctx.fm.getVirtualFileSystem().getBufferForFile(path);
+  if (auto ec = bufferOrErr.getError())
+    return errorCodeToError(ec);
+
+  // Check for dynamic libs and text-based stub files.
+  if (!ctx.registry.canRead(bufferOrErr.get()->getMemBufferRef(),
+                            FileType::MachO_DynamicLibrary |
+                                FileType::MachO_DynamicLibrary_Stub |
+                                Registry::getTextFileType()))
+    return nullptr;
+
+  if (path.endswith(".tbd")) {
+    auto file = ctx.registry.readTextFile(std::move(bufferOrErr.get()),
+                                          ReadFlags::Symbols);
+    if (!file)
+      return file.takeError();
+    return std::move(*file);
+  }
+
+  auto file =
+      ctx.registry.readFile(std::move(bufferOrErr.get()), ReadFlags::Symbols);
+  if (!file)
+    return file.takeError();
+  return convertToInterfaceFile(*file);
+}
+
 /// \brief Converts all dynamic libraries/frameworks to text-based stubs if
 /// possible. Also create the same symlinks as the ones that pointed to the
 /// original library. If requested the source library will be deleted.
@@ -300,6 +335,7 @@ static bool stubifyDirectory(Context &ctx) {
   std::map<std::string, std::unique_ptr<InterfaceFile>> dylibs;
   std::map<std::string, std::string> originalNames;
   std::set<std::pair<std::string, bool>> toDelete;
+  std::vector<std::string> files;
   std::error_code ec;
   for (sys::fs::recursive_directory_iterator i(ctx.inputPath, ec), ie; i != ie;
        i.increment(ec)) {
@@ -412,40 +448,34 @@ static bool stubifyDirectory(Context &ctx) {
       continue;
     }
 
-    auto bufferOrErr = ctx.fm.getBufferForFile(*file);
-    if (auto ec = bufferOrErr.getError()) {
-      ctx.diag.report(diag::err_cannot_read_file) << path << ec.message();
+    files.emplace_back(path);
+  }
+
+  // Read and convert the files on the worker pool. The results are processed
+  // in the order the files were found, which keeps the output identical to a
+  // serial run.
+  std::vector<std::optional<Expected<std::unique_ptr<InterfaceFile>>>>
+      results(files.size());
+  parallelForEachIndex(files.size(), ctx.numThreads, [&](size_t i) {
+    results[i].emplace(readLibraryFile(ctx, files[i]));
+  });
+
+  for (size_t i = 0; i < files.size(); ++i) {
+    StringRef path = files[i];
+    auto &interfaceOrErr = *results[i];
+    if (!interfaceOrErr) {
+      ctx.diag.report(diag::err_cannot_read_file)
+          << path << toString(interfaceOrErr.takeError());
+      for (auto &result : make_range(results.begin() + i + 1, results.end()))
+        if (!*result)
+          consumeError(result->takeError());
       return false;
     }
 
-    // Check for dynamic libs and text-based stub files.
-    if (!ctx.registry.canRead(bufferOrErr.get()->getMemBufferRef(),
-                              FileType::MachO_DynamicLibrary |
-                                  FileType::MachO_DynamicLibrary_Stub |
-                                  Registry::getTextFileType()))
+    auto interface = std::move(*interfaceOrErr);
+    if (!interface)
       continue;
 
-    std::unique_ptr<InterfaceFile> interface = nullptr;
-    if (path.endswith(".tbd")) {
-      auto file2 = ctx.registry.readTextFile(std::move(bufferOrErr.get()),
-                                             ReadFlags::Symbols);
-      if (!file2) {
-        ctx.diag.report(diag::err_cannot_read_file)
-            << path << toString(file2.takeError());
-        return false;
-      }
-      interface = std::move(*file2);
-    } else {
-      auto file2 = ctx.registry.readFile(std::move(bufferOrErr.get()),
-                                         ReadFlags::Symbols);
-      if (!file2) {
-        ctx.diag.report(diag::err_cannot_read_file)
-            << path << toString(file2.takeError());
-        return false;
-      }
-      interface = convertToInterfaceFile(*file2);
-    }
-
     if (ctx.traceLibraryLocation)
       errs() << path << "\n";
 
@@ -476,35 +506,19 @@ static bool stubifyDirectory(Context &ctx) {
                      std::forward_as_tuple(std::move(interface)));
   }
 
-  for (auto &it : dylibs) {
-    auto &dylib = it.second;
-    SmallString<PATH_MAX> input(dylib->getPath());
-    SmallString<PATH_MAX> output = input;
+  auto getOutputPath = [](InterfaceFile *dylib) {
+    SmallString<PATH_MAX> output(dylib->getPath());
     TAPI_INTERNAL::replace_extension(output, ".tbd");
+    return std::string(output);
+  };
 
-    if (!ctx.registry.canWrite(dylib.get(), ctx.fileType)) {
-      ctx.diag.report(diag::err_cannot_convert_dylib) << dylib->getPath();
-      return false;
-    }
-
-    if (ctx.inlinePrivateFrameworks && !inlineFrameworks(ctx, dylib.get()))
-      return false;
-
-
-    auto result = ctx.interfaceMgr.writeFile(std::string(output), dylib.get(),
-                                             ctx.fileType);
-    if (result) {
-      ctx.diag.report(diag::err_cannot_write_file)
-          << output << toString(std::move(result));
-      return false;
-    }
-
+  auto createSymlinks = [&](InterfaceFile *dylib) {
     // Get the original file name.
     SmallString<PATH_MAX> normalizedPath(dylib->getPath());
     TAPI_INTERNAL::replace_extension(normalizedPath, "");
     auto it2 = originalNames.find(normalizedPath.c_str());
     if (it2 == originalNames.end())
-      continue;
+      return true;
     auto originalName = it2->second;
 
     if (ctx.deleteInputFile)
@@ -539,6 +553,90 @@ static bool stubifyDirectory(Context &ctx) {
       } else
         break;
     }
+    return true;
+  };
+
+  if (ctx.inlinePrivateFrameworks) {
+    // Inlining resolves reexports through findLibrary, which prefers the stubs
+    // of the libraries that were already written. Keep inlining, writing and
+    // symlinking each library before the next one is processed.
+    for (auto &it : dylibs) {
+      auto *dylib = it.second.get();
+      if (!ctx.registry.canWrite(dylib, ctx.fileType)) {
+        ctx.diag.report(diag::err_cannot_convert_dylib) << dylib->getPath();
+        return false;
+      }
+
+      if (!inlineFrameworks(ctx, dylib))
+        return false;
+
+      auto output = getOutputPath(dylib);
+      auto result = ctx.interfaceMgr.writeFile(output, dylib, ctx.fileType);
+      if (result) {
+        ctx.diag.report(diag::err_cannot_write_file)
+            << output << toString(std::move(result));
+        return false;
+      }
+
+      if (!createSymlinks(dylib))
+        return false;
+    }
+  } else {
+    // Without inlining the stubs don't depend on each other and are written on
+    // the worker pool. Only the libraries before the first one that cannot be
+    // converted are written, like in a serial run.
+    std::vector<InterfaceFile *> outputs;
+    InterfaceFile *unconvertible = nullptr;
+    for (auto &it : dylibs) {
+      if (!ctx.registry.canWrite(it.second.get(), ctx.fileType)) {
+        unconvertible = it.second.get();
+        break;
+      }
+      outputs.push_back(it.second.get());
+    }
+
+    // Indices are handed out in order, so a write that is skipped after a
+    // failure always comes after the failed one.
+    std::atomic<bool> hasWriteError{false};
+    std::vector<std::optional<Error>> writeResults(outputs.size());
+    parallelForEachIndex(outputs.size(), ctx.numThreads, [&](size_t i) {
+      if (hasWriteError)
+        return;
+      auto result = ctx.interfaceMgr.writeFile(getOutputPath(outputs[i]),
+                                               outputs[i], ctx.fileType);
+      if (result)
+        hasWriteError = true;
+      writeResults[i].emplace(std::move(result));
+    });
+
+    // Report the first failure and create the symlinks of the stubs written
+    // before it, in the order of a serial run.
+    bool failed = false;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (!writeResults[i])
+        continue;
+      auto &result = *writeResults[i];
+      if (failed) {
+        consumeError(std::move(result));
+        continue;
+      }
+      if (result) {
+        ctx.diag.report(diag::err_cannot_write_file)
+            << getOutputPath(outputs[i]) << toString(std::move(result));
+        failed = true;
+        continue;
+      }
+      if (!createSymlinks(outputs[i]))
+        failed = true;
+    }
+    if (failed)
+      return false;
+
+    if (unconvertible) {
+      ctx.diag.report(diag::err_cannot_convert_dylib)
+          << unconvertible->getPath();
+      return false;
+    }
   }
 
   // Recursively delete the directories (this will abort when they are not empty
@@ -587,6 +685,7 @@ bool Driver::Stub::run(DiagnosticsEngine &diag, Options &opts) {
   ctx.deletePrivateFrameworks = opts.tapiOptions.deletePrivateFrameworks;
   ctx.traceLibraryLocation = opts.tapiOptions.traceLibraryLocation;
   ctx.removeSharedCacheFlag = opts.tapiOptions.removeSharedCacheFlag;
+  ctx.numThreads = opts.driverOptions.numThreads;
 
 
   // Handle isysroot.
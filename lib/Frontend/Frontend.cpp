@@ -130,7 +130,8 @@ CompilerInvocation *newInvocation(clang::DiagnosticsEngine *diagnostics,
 }
 
 static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
-                     std::unique_ptr<llvm::MemoryBuffer> input) {
+                     std::unique_ptr<llvm::MemoryBuffer> input,
+                     raw_ostream &os) {
   context.compiler = std::make_unique<CompilerInstance>();
   IntrusiveRefCntPtr<DiagnosticIDs> diagID(new DiagnosticIDs());
   IntrusiveRefCntPtr<DiagnosticOptions> diagOpts(new DiagnosticOptions());
@@ -144,7 +145,7 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
   llvm::opt::InputArgList parsedArgs = opts.ParseArgs(
       ArrayRef<const char *>(argv).slice(1), MissingArgIndex, MissingArgCount);
   ParseDiagnosticArgs(*diagOpts, parsedArgs);
-  TextDiagnosticPrinter diagnosticPrinter(llvm::errs(), &*diagOpts);
+  TextDiagnosticPrinter diagnosticPrinter(os, &*diagOpts);
   clang::DiagnosticsEngine diagnosticsEngine(diagID, &*diagOpts,
                                              &diagnosticPrinter, false);
 
@@ -167,9 +168,9 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
 
   // Show the invocation, with -v.
   if (invocation->getHeaderSearchOpts().Verbose) {
-    llvm::errs() << "clang Invocation:\n";
-    compilation->getJobs().Print(llvm::errs(), "\n", true);
-    llvm::errs() << "\n";
+    os << "clang Invocation:\n";
+    compilation->getJobs().Print(os, "\n", true);
+    os << "\n";
   }
 
   if (input)
@@ -182,7 +183,8 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
   auto action = std::make_unique<APIVisitorAction>(context);
 
   // Create the compiler's actual diagnostics engine.
-  context.compiler->createDiagnostics();
+  context.compiler->createDiagnostics(
+      new TextDiagnosticPrinter(os, &context.compiler->getDiagnosticOpts()));
   if (!context.compiler->hasDiagnostics())
     return false;
 
@@ -194,22 +196,21 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
 
 static std::string getClangExecutablePath() {
   static int staticSymbol;
-  static std::string clangExecutablePath;
-
-  if (!clangExecutablePath.empty())
-    return clangExecutablePath;
-
-  // Try to find clang first in the toolchain. If that fails, then fall-back to
-  // the default search PATH.
-  auto mainExecutable = sys::fs::getMainExecutable("tapi", &staticSymbol);
-  StringRef toolchainBinDir = sys::path::parent_path(mainExecutable);
-  auto clangBinary = sys::findProgramByName("clang", ArrayRef(toolchainBinDir));
-  if (clangBinary.getError())
-    clangBinary = sys::findProgramByName("clang");
-  if (auto ec = clangBinary.getError())
-    clangExecutablePath = "clang";
-  else
-    clangExecutablePath = clangBinary.get();
+  // Computed once. Frontend jobs can run concurrently, so rely on the
+  // thread-safe initialization of function local statics.
+  static const std::string clangExecutablePath = []() -> std::string {
+    // Try to find clang first in the toolchain. If that fails, then fall-back
+    // to the default search PATH.
+    auto mainExecutable = sys::fs::getMainExecutable("tapi", &staticSymbol);
+    StringRef toolchainBinDir = sys::path::parent_path(mainExecutable);
+    auto clangBinary =
+        sys::findProgramByName("clang", ArrayRef(toolchainBinDir));
+    if (clangBinary.getError())
+      clangBinary = sys::findProgramByName("clang");
+    if (auto ec = clangBinary.getError())
+      return "clang";
+    return clangBinary.get();
+  }();
 
   return clangExecutablePath;
 }
@@ -261,7 +262,7 @@ createInputBuffer(const FrontendJob &job, FrontendContext &context,
 
 static void createClangReproducer(const FrontendJob &job,
                                   const std::vector<std::string> &args,
-                                  FrontendContext &context) {
+                                  FrontendContext &context, raw_ostream &os) {
   std::string tempFileTemplate = job.clangReproducerPath.empty()
                                      ? "/tmp/tapi_include_headers-%%%%%%"
                                      : job.clangReproducerPath;
@@ -270,7 +271,7 @@ static void createClangReproducer(const FrontendJob &job,
   int fd;
   auto ec = sys::fs::createUniqueFile(tempFileTemplate, fd, tempFile);
   if (ec) {
-    errs() << "Cannot create temporary file for clang reproducer\n";
+    os << "Cannot create temporary file for clang reproducer\n";
     return;
   }
   raw_fd_ostream fs(fd, /*shouldClose=*/ true);
@@ -281,7 +282,7 @@ static void createClangReproducer(const FrontendJob &job,
   sys::path::replace_extension(tempFile, "sh");
   raw_fd_ostream sh(tempFile, ec);
   if (ec) {
-    errs() << "Cannot create temporary file for clang reproducer\n";
+    os << "Cannot create temporary file for clang reproducer\n";
     return;
   }
   SmallString<2048> argStr;
@@ -297,11 +298,11 @@ static void createClangReproducer(const FrontendJob &job,
   sys::path::replace_extension(
       diagPath,
       "{" + getFileExtension(job.language).drop_front(1).str() + ",sh}");
-  errs() << "\nNote: a reproducer of the error is written to: \"" << diagPath
-         << "\".\n";
-  errs() << "Note: the reproducer is intended to help users to debug the issue "
-            "under a more familiar context using clang.\n";
-  errs() << "Note: the paths in the reproducer might need to be adjusted.\n";
+  os << "\nNote: a reproducer of the error is written to: \"" << diagPath
+     << "\".\n";
+  os << "Note: the reproducer is intended to help users to debug the issue "
+        "under a more familiar context using clang.\n";
+  os << "Note: the paths in the reproducer might need to be adjusted.\n";
 }
 
 extern Expected<FrontendContext> runFrontend(const FrontendJob &job,
@@ -449,13 +450,14 @@ extern Expected<FrontendContext> runFrontend(const FrontendJob &job,
   for (const auto &header : job.prefixHeaders)
     args.emplace_back("-include" + header);
 
+  auto &os = job.diagnosticOutput ? *job.diagnosticOutput : errs();
   args.emplace_back(inputFilePath);
-  if (runClang(context, args, std::move(input)))
+  if (runClang(context, args, std::move(input), os))
     return context;
 
   // Create a reproducer.
   if (inputFilename.empty() && job.createClangReproducer)
-    createClangReproducer(job, args, context);
+    createClangReproducer(job, args, context, os);
 
   return make_error<TextAPIError>(TextAPIErrorCode::GenericFrontendError);
 }
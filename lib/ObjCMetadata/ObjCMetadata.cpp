@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 #include "tapi/ObjCMetadata/ObjCMetadata.h"
 #include "macho-obj.h"
+#include "llvm/ADT/STLExtras.h"
 
 using namespace llvm;
 using namespace object;
@@ -228,6 +229,8 @@ static Error unsupportedObjCRuntimeError() {
 ObjCMetaDataReader::ObjCMetaDataReader(object::MachOObjectFile *Binary,
                                        Error &Err)
     : OwningBinary(Binary) {
+  buildAddressIndex();
+
   // Identify ObjC Version.
   if (getSection("__OBJC", "__module_info") != SectionRef() &&
       !OwningBinary->is64Bit())
@@ -1519,63 +1522,108 @@ const SectionRef ObjCMetaDataReader::getSection(const char *segname,
   return SectionRef();
 }
 
-Expected<object::SectionRef>
-ObjCMetaDataReader::getSectionFromAddress(uint64_t Address) const {
+void ObjCMetaDataReader::buildAddressIndex() {
   for (const SectionRef &Section : OwningBinary->sections()) {
-    uint64_t SectAddress = Section.getAddress();
     uint64_t SectSize = Section.getSize();
     if (SectSize == 0)
       continue;
-    if (Address >= SectAddress && Address < SectAddress + SectSize)
-      return Section;
+    uint64_t SectAddress = Section.getAddress();
+    SectionRanges.push_back({SectAddress, SectAddress + SectSize, Section});
+  }
+  llvm::stable_sort(SectionRanges,
+                    [](const SectionRange &LHS, const SectionRange &RHS) {
+                      return LHS.Start < RHS.Start;
+                    });
+  for (size_t I = 1; I < SectionRanges.size(); ++I) {
+    if (SectionRanges[I].Start < SectionRanges[I - 1].End) {
+      HasOverlappingSections = true;
+      break;
+    }
+  }
+
+  // Collect the encrypted file ranges. Most binaries have none, so the segment
+  // mappings are only needed if there are any.
+  for (const auto &LC : OwningBinary->load_commands()) {
+    if (LC.C.cmd == MachO::LC_ENCRYPTION_INFO_64 && OwningBinary->is64Bit()) {
+      MachO::encryption_info_command_64 Cmd =
+          OwningBinary->getEncryptionInfoCommand64(LC);
+      if (Cmd.cryptid != 0)
+        EncryptedFileRanges.emplace_back(Cmd.cryptoff,
+                                         Cmd.cryptoff + Cmd.cryptsize);
+    } else if (LC.C.cmd == MachO::LC_ENCRYPTION_INFO &&
+               !OwningBinary->is64Bit()) {
+      MachO::encryption_info_command Cmd =
+          OwningBinary->getEncryptionInfoCommand(LC);
+      if (Cmd.cryptid != 0)
+        EncryptedFileRanges.emplace_back(Cmd.cryptoff,
+                                         Cmd.cryptoff + Cmd.cryptsize);
+    }
+  }
+  if (EncryptedFileRanges.empty())
+    return;
+
+  for (const auto &LC : OwningBinary->load_commands()) {
+    if (LC.C.cmd == MachO::LC_SEGMENT_64 && OwningBinary->is64Bit()) {
+      MachO::segment_command_64 Cmd =
+          OwningBinary->getSegment64LoadCommand(LC);
+      Segments.push_back({Cmd.vmaddr, Cmd.vmsize, Cmd.fileoff});
+    } else if (LC.C.cmd == MachO::LC_SEGMENT && !OwningBinary->is64Bit()) {
+      MachO::segment_command Cmd = OwningBinary->getSegmentLoadCommand(LC);
+      Segments.push_back({Cmd.vmaddr, Cmd.vmsize, Cmd.fileoff});
+    }
+  }
+}
+
+std::optional<object::SectionRef>
+ObjCMetaDataReader::lookupSection(uint64_t Address) const {
+  if (HasOverlappingSections) {
+    for (const SectionRef &Section : OwningBinary->sections()) {
+      uint64_t SectAddress = Section.getAddress();
+      uint64_t SectSize = Section.getSize();
+      if (SectSize == 0)
+        continue;
+      if (Address >= SectAddress && Address < SectAddress + SectSize)
+        return Section;
+    }
+    return std::nullopt;
   }
+
+  // Find the last section starting at or before the address.
+  auto It = llvm::upper_bound(
+      SectionRanges, Address,
+      [](uint64_t Addr, const SectionRange &Range) {
+        return Addr < Range.Start;
+      });
+  if (It == SectionRanges.begin())
+    return std::nullopt;
+  --It;
+  if (Address >= It->End)
+    return std::nullopt;
+  return It->Section;
+}
+
+Expected<object::SectionRef>
+ObjCMetaDataReader::getSectionFromAddress(uint64_t Address) const {
+  if (auto Section = lookupSection(Address))
+    return *Section;
   return make_error<StringError>("requested address not in section",
                                  object_error::parse_failed);
 }
 
 bool ObjCMetaDataReader::isAddressEncrypted(uint64_t Address) const {
-  // Find encrypted range.
-  if (OwningBinary->is64Bit()) {
-    uint64_t fileOffset = 0;
-    for (const auto &LC : OwningBinary->load_commands()) {
-      if (LC.C.cmd == MachO::LC_SEGMENT_64) {
-        MachO::segment_command_64 cmd =
-            OwningBinary->getSegment64LoadCommand(LC);
-        if (Address > cmd.vmaddr && Address < cmd.vmaddr + cmd.vmsize)
-          fileOffset = Address - cmd.vmaddr + cmd.fileoff;
-      }
-    }
-    for (const auto &LC : OwningBinary->load_commands()) {
-      if (LC.C.cmd == MachO::LC_ENCRYPTION_INFO_64) {
-        MachO::encryption_info_command_64 cmd =
-            OwningBinary->getEncryptionInfoCommand64(LC);
-        if (cmd.cryptid == 0)
-          continue;
-        if (fileOffset > cmd.cryptoff &&
-            fileOffset < cmd.cryptoff + cmd.cryptsize)
-          return true;
-      }
-    }
-  } else {
-    uint64_t fileOffset = 0;
-    for (const auto &LC : OwningBinary->load_commands()) {
-      if (LC.C.cmd == MachO::LC_SEGMENT) {
-        MachO::segment_command cmd = OwningBinary->getSegmentLoadCommand(LC);
-        if (Address > cmd.vmaddr && Address < cmd.vmaddr + cmd.vmsize)
-          fileOffset = Address - cmd.vmaddr + cmd.fileoff;
-      }
-    }
-    for (const auto &LC : OwningBinary->load_commands()) {
-      if (LC.C.cmd == MachO::LC_ENCRYPTION_INFO) {
-        MachO::encryption_info_command cmd =
-            OwningBinary->getEncryptionInfoCommand(LC);
-        if (cmd.cryptid == 0)
-          continue;
-        if (fileOffset > cmd.cryptoff &&
-            fileOffset < cmd.cryptoff + cmd.cryptsize)
-          return true;
-      }
-    }
+  if (EncryptedFileRanges.empty())
+    return false;
+
+  // Map the address to a file offset. The last matching segment wins.
+  uint64_t FileOffset = 0;
+  for (const auto &Segment : Segments) {
+    if (Address > Segment.VMAddr && Address < Segment.VMAddr + Segment.VMSize)
+      FileOffset = Address - Segment.VMAddr + Segment.FileOff;
+  }
+
+  for (const auto &Range : EncryptedFileRanges) {
+    if (FileOffset > Range.first && FileOffset < Range.second)
+      return true;
   }
   return false;
 }
@@ -1593,29 +1641,24 @@ Expected<T> ObjCMetaDataReader::getData(uint64_t VMAddr) const {
   if (isAddressEncrypted(VMAddr))
     return make_error<StringError>("vmaddr is encrypted",
                                    object_error::parse_failed);
-  for (const SectionRef &Section : OwningBinary->sections()) {
-    uint64_t SectAddress = Section.getAddress();
-    uint64_t SectSize = Section.getSize();
-    if (SectSize == 0)
-      continue;
-    if (VMAddr >= SectAddress && VMAddr < SectAddress + SectSize) {
-      uint64_t Offset = VMAddr - SectAddress;
-      auto SectContents = Section.getContents();
-      if (!SectContents)
-        return SectContents.takeError();
-      if (Offset + sizeof(T) > SectSize)
-        return make_error<StringError>(
-            "Data extends pass the end of the section",
-            object_error::parse_failed);
-      T Data;
-      memcpy(&Data, SectContents->data() + Offset, sizeof(T));
-      if (OwningBinary->isLittleEndian() != sys::IsLittleEndianHost)
-        swapStruct(Data);
-      return Data;
-    }
-  }
-  return make_error<StringError>("requested address out of bound",
-                                 object_error::parse_failed);
+  auto Section = lookupSection(VMAddr);
+  if (!Section)
+    return make_error<StringError>("requested address out of bound",
+                                   object_error::parse_failed);
+
+  uint64_t SectSize = Section->getSize();
+  uint64_t Offset = VMAddr - Section->getAddress();
+  auto SectContents = Section->getContents();
+  if (!SectContents)
+    return SectContents.takeError();
+  if (Offset + sizeof(T) > SectSize)
+    return make_error<StringError>("Data extends pass the end of the section",
+                                   object_error::parse_failed);
+  T Data;
+  memcpy(&Data, SectContents->data() + Offset, sizeof(T));
+  if (OwningBinary->isLittleEndian() != sys::IsLittleEndianHost)
+    swapStruct(Data);
+  return Data;
 }
 
 Expected<StringRef> ObjCMetaDataReader::getString(uint64_t VMAddr,
@@ -1623,31 +1666,25 @@ Expected<StringRef> ObjCMetaDataReader::getString(uint64_t VMAddr,
   if (isAddressEncrypted(VMAddr))
     return "#EncryptedString#";
 
-  for (const SectionRef &Section : OwningBinary->sections()) {
-    uint64_t SectAddress = Section.getAddress();
-    uint64_t SectSize = Section.getSize();
-    if (SectSize == 0)
-      continue;
-    if (VMAddr >= SectAddress && VMAddr < SectAddress + SectSize) {
-      uint64_t Offset = VMAddr - SectAddress;
-      auto SectContents = Section.getContents();
-      if (!SectContents)
-        return SectContents.takeError();
-      StringRef Target = StringRef(SectContents->data() + Offset);
-      if (Target.size() + Offset >= SectSize)
-        return make_error<StringError>(
-            "Data extends pass the end of the section",
-            object_error::parse_failed);
-      if (Target.empty() && !AllowEmpty)
-        return make_error<StringError>(
-            "Expect to read a none zero length string",
-            object_error::parse_failed);
-
-      return Target;
-    }
-  }
-  return make_error<StringError>("string out of bound",
-                                 object_error::parse_failed);
+  auto Section = lookupSection(VMAddr);
+  if (!Section)
+    return make_error<StringError>("string out of bound",
+                                   object_error::parse_failed);
+
+  uint64_t SectSize = Section->getSize();
+  uint64_t Offset = VMAddr - Section->getAddress();
+  auto SectContents = Section->getContents();
+  if (!SectContents)
+    return SectContents.takeError();
+  StringRef Target = StringRef(SectContents->data() + Offset);
+  if (Target.size() + Offset >= SectSize)
+    return make_error<StringError>("Data extends pass the end of the section",
+                                   object_error::parse_failed);
+  if (Target.empty() && !AllowEmpty)
+    return make_error<StringError>("Expect to read a none zero length string",
+                                   object_error::parse_failed);
+
+  return Target;
 }
 
 Expected<uint64_t>
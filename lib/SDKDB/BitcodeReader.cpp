@@ -79,6 +79,84 @@ public:
                                      support::unaligned>(data);
   }
 };
+
+class SymbolTableInfo {
+  const char *identifiers;
+
+public:
+  SymbolTableInfo(const char *identifiers) : identifiers(identifiers) {}
+
+  using internal_key_type = StringRef;
+  using external_key_type = StringRef;
+  using data_type = std::vector<SDKDBSymbolTableEntry>;
+  using hash_value_type = uint64_t;
+  using offset_type = unsigned;
+
+  // InstallName: offset=32 length=16. Library block: offset=64.
+  // Availability: introduced=32 obsoleted=32 flags=8. Access=8 linkage=8.
+  static constexpr offset_type entryLength = 4 + 2 + 8 + 4 + 4 + 1 + 1 + 1;
+
+  // NOLINTNEXTLINE
+  internal_key_type GetInternalKey(external_key_type key) { return key; }
+
+  // NOLINTNEXTLINE
+  external_key_type GetExternalKey(internal_key_type key) { return key; }
+
+  // NOLINTNEXTLINE
+  hash_value_type ComputeHash(internal_key_type key) { return hash_value(key); }
+
+  // NOLINTNEXTLINE
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<offset_type, offset_type> // NOLINTNEXTLINE
+  ReadKeyDataLength(const uint8_t *&data) {
+    // StringRef: offset=32 length=16.
+    offset_type keyLength = sizeof(uint32_t) + sizeof(uint16_t);
+    offset_type dataLength = support::endian::readNext<
+        uint32_t, support::little, support::unaligned>(data);
+    return {keyLength, dataLength};
+  }
+
+  // NOLINTNEXTLINE
+  internal_key_type ReadKey(const uint8_t *data, offset_type KeyLen) {
+    auto offset = support::endian::readNext<uint32_t, support::little,
+                                            support::unaligned>(data);
+    auto size = support::endian::readNext<uint16_t, support::little,
+                                          support::unaligned>(data);
+    return StringRef(identifiers + offset, size);
+  }
+
+  // NOLINTNEXTLINE
+  data_type ReadData(internal_key_type key, const uint8_t *data,
+                     offset_type length) {
+    using namespace support::endian;
+    data_type entries;
+    for (unsigned i = 0, e = length / entryLength; i != e; ++i) {
+      SDKDBSymbolTableEntry entry;
+      auto offset =
+          readNext<uint32_t, support::little, support::unaligned>(data);
+      auto size = readNext<uint16_t, support::little, support::unaligned>(data);
+      entry.installName = StringRef(identifiers + offset, size);
+      entry.libraryOffset =
+          readNext<uint64_t, support::little, support::unaligned>(data);
+      entry.availability._introduced =
+          readNext<uint32_t, support::little, support::unaligned>(data);
+      entry.availability._obsoleted =
+          readNext<uint32_t, support::little, support::unaligned>(data);
+      auto flags = readNext<uint8_t, support::little, support::unaligned>(data);
+      entry.availability._unavailable = flags & 0x1;
+      entry.availability._isSPIAvailable = flags & 0x2;
+      entry.access = (APIAccess)readNext<uint8_t, support::little,
+                                         support::unaligned>(data);
+      entry.linkage = (APILinkage)readNext<uint8_t, support::little,
+                                           support::unaligned>(data);
+      entries.push_back(entry);
+    }
+    return entries;
+  }
+};
 } // end anonymous namespace
 
 SDKDBBitcodeMaterializeOption SDKDBBitcodeMaterializeOption::defaultOption =
@@ -89,6 +167,10 @@ public:
   Implementation(MemoryBufferRef input, SDKDBBitcodeMaterializeOption &option,
                  Error &err);
 
+  void setOwnedBuffer(std::unique_ptr<MemoryBuffer> buffer) {
+    ownedBuffer = std::move(buffer);
+  }
+
   const std::vector<Triple> &getAvailableTriples() const { return triples; }
 
   Error materialize(SDKDBBuilder &builder) const;
@@ -97,10 +179,13 @@ public:
 
   std::string getBuildVersion() const;
 
-  Expected<bool> dylibExistsForPath(Triple &target, StringRef path);
+  Expected<bool> dylibExistsForPath(Triple &target, StringRef path) const;
+
+  Expected<std::vector<SDKDBSymbolTableEntry>>
+  lookupSymbol(const Triple &target, StringRef name) const;
 
   Error loadAPIsFromSDKDB(SDKDBBuilder &builder, Triple &target,
-                          StringRef path);
+                          StringRef path) const;
 
   const std::vector<std::string> &getProjectsWithError() const {
     return projectWithError;
@@ -114,9 +199,14 @@ public:
     return (bool)(builderOpts & SDKDBBuilderOptions::noObjCMetadata);
   }
 
+  bool hasSymbolTable() const {
+    return (bool)(builderOpts & SDKDBBuilderOptions::hasSymbolTable);
+  }
+
 private:
   using SerializedLibraryTable =
       OnDiskIterableChainedHashTable<LibraryTableInfo>;
+  using SerializedSymbolTable = OnDiskChainedHashTable<SymbolTableInfo>;
 
   // helper functions.
   // TODO: handle newly added fields in BitCode:
@@ -128,7 +218,7 @@ private:
   Error readBlockInfoBlock(BitstreamCursor &cursor,
                            BitstreamBlockInfo &info) const;
   Error readControlBlock(BitstreamCursor &cursor);
-  Error readIdentificationBlock(BitstreamCursor &cursor) const;
+  Error readIdentificationBlock(BitstreamCursor &cursor);
   Error readSDKDBBlock(BitstreamCursor &cursor, SDKDBBuilder &builder) const;
   Expected<API *> readAPIBlock(BitstreamCursor &cursor, SDKDB &sdkdb) const;
   Error readGlobalBlock(BitstreamCursor &cursor, API &api) const;
@@ -147,21 +237,29 @@ private:
   Error readTypedefBlock(BitstreamCursor &cursor, API &api) const;
 
   Expected<StringRef> readStringFromTable(unsigned offset, unsigned size) const;
-  Expected<APIRecord> readAPIRecordFromScratch() const;
-  Error readAvailabilityInfoFromScratch(APIRecord &record) const;
-  Error readFilenameFromScratch(APIRecord &record) const;
-  Error readSourceLocationFromScratch(APIRecord &record) const;
-
-  Error materializeLibraryTable() const;
-  Error readLibraryTableBlock(BitstreamCursor &cursor) const;
+  Expected<APIRecord>
+  readAPIRecordFromScratch(ArrayRef<uint64_t> scratch) const;
+  Error readAvailabilityInfoFromScratch(ArrayRef<uint64_t> scratch,
+                                        APIRecord &record) const;
+  Error readFilenameFromScratch(ArrayRef<uint64_t> scratch,
+                                APIRecord &record) const;
+  Error readSourceLocationFromScratch(ArrayRef<uint64_t> scratch,
+                                      APIRecord &record) const;
+
+  Error readLibraryTableBlock(BitstreamCursor &cursor);
+  Error readSymbolTableBlock(BitstreamCursor &cursor);
 
   // Look for offset of the library in the dylibTable.
-  Expected<uint64_t> getOffsetForLibrary(Triple &target, StringRef path);
+  uint64_t getOffsetForLibrary(const Triple &target, StringRef path) const;
   // Look for offset of the library and taking fallback targets into
   // consideration.
-  Expected<uint64_t> findOffsetForLibrary(Triple &target, StringRef path);
+  uint64_t findOffsetForLibrary(const Triple &target, StringRef path) const;
 
+  // All the state below is set up while validating the SDKDB and never
+  // changes afterwards, so queries can run concurrently. Every query uses its
+  // own cursor and scratch space.
   MemoryBufferRef input;
+  std::unique_ptr<MemoryBuffer> ownedBuffer;
   SDKDBBitcodeMaterializeOption &option;
   SDKDBBuilderOptions builderOpts;
   std::vector<Triple> triples;
@@ -170,14 +268,23 @@ private:
   std::string buildVersion;
   std::vector<std::string> projectWithError;
 
+  // Abbreviations shared by all the cursors. The cursors only read from it,
+  // but require a non-const pointer.
+  mutable BitstreamBlockInfo blockInfo;
+
+  // Start of the first SDKDB block, used to enter the SDKDB block context
+  // before jumping to a library.
+  uint64_t sdkdbBlockStart = 0;
+
   // stringTable.
-  mutable StringRef stringTable;
+  StringRef stringTable;
 
   // lookupTable for dylibs
-  mutable StringMap<std::unique_ptr<SerializedLibraryTable>> dylibTable;
+  StringMap<std::unique_ptr<SerializedLibraryTable>> dylibTable;
+
+  // lookupTable for exported symbols.
+  StringMap<std::unique_ptr<SerializedSymbolTable>> symbolTable;
 
-  // scatch space.
-  mutable SmallVector<uint64_t, 64> scratch;
 };
 
 SDKDBBitcodeReader::SDKDBBitcodeReader(MemoryBufferRef input,
@@ -198,6 +305,23 @@ SDKDBBitcodeReader::get(MemoryBufferRef input,
   return reader;
 }
 
+Expected<std::unique_ptr<SDKDBBitcodeReader>>
+SDKDBBitcodeReader::getFromFile(StringRef path,
+                                SDKDBBitcodeMaterializeOption &option) {
+  // Large files are mapped instead of read into memory.
+  auto bufferOrErr = MemoryBuffer::getFile(path, /*IsText=*/false,
+                                           /*RequiresNullTerminator=*/false);
+  if (!bufferOrErr)
+    return errorCodeToError(bufferOrErr.getError());
+
+  auto reader = get((*bufferOrErr)->getMemBufferRef(), option);
+  if (!reader)
+    return reader.takeError();
+
+  (*reader)->impl.setOwnedBuffer(std::move(*bufferOrErr));
+  return reader;
+}
+
 const std::vector<Triple> &SDKDBBitcodeReader::getAvailableTriples() const {
   return impl.getAvailableTriples();
 }
@@ -220,12 +344,18 @@ std::string SDKDBBitcodeReader::getBuildVersion() const {
 }
 
 Expected<bool> SDKDBBitcodeReader::dylibExistsForPath(Triple &target,
-                                                      StringRef path) {
+                                                      StringRef path) const {
   return impl.dylibExistsForPath(target, path);
 }
 
+Expected<std::vector<SDKDBSymbolTableEntry>>
+SDKDBBitcodeReader::lookupSymbol(const Triple &target, StringRef name) const {
+  return impl.lookupSymbol(target, name);
+}
+
 Error SDKDBBitcodeReader::loadAPIsFromSDKDB(SDKDBBuilder &builder,
-                                            Triple &target, StringRef path) {
+                                            Triple &target,
+                                            StringRef path) const {
   return impl.loadAPIsFromSDKDB(builder, target, path);
 }
 
@@ -249,6 +379,10 @@ bool SDKDBBitcodeReader::noObjCMetadata() const {
   return impl.noObjCMetadata();
 }
 
+bool SDKDBBitcodeReader::hasSymbolTable() const {
+  return impl.hasSymbolTable();
+}
+
 Error SDKDBBitcodeReader::Implementation::readSignature(
     BitstreamCursor &cursor) const {
   // Validate signature.
@@ -287,6 +421,7 @@ Error SDKDBBitcodeReader::Implementation::readControlBlock(
   if (auto err = cursor.EnterSubBlock(CONTROL_BLOCK_ID))
     return err;
 
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -342,17 +477,11 @@ Error SDKDBBitcodeReader::Implementation::readControlBlock(
 }
 
 Error SDKDBBitcodeReader::Implementation::readIdentificationBlock(
-    BitstreamCursor &cursor) const {
-  // If the identification block is already read, skip block.
-  if (!stringTable.empty()) {
-    if (auto err = cursor.SkipBlock())
-      return err;
-    return Error::success();
-  }
-
+    BitstreamCursor &cursor) {
   if (auto err = cursor.EnterSubBlock(IDENTIFIER_BLOCK_ID))
     return err;
 
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -399,6 +528,7 @@ Error SDKDBBitcodeReader::Implementation::readTripleFromSDKDB(
   if (auto err = cursor.EnterSubBlock(SDKDB_BLOCK_ID))
     return err;
 
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -448,11 +578,12 @@ Error SDKDBBitcodeReader::Implementation::readTripleFromSDKDB(
 
 Error SDKDBBitcodeReader::Implementation::validateSDKDB() {
   BitstreamCursor cursor(input);
-  BitstreamBlockInfo blockInfo;
 
   if (auto err = readSignature(cursor))
     return err;
 
+  // Scan the top level blocks once and keep everything that is needed to
+  // answer queries later on.
   while (!cursor.AtEndOfStream()) {
     auto maybeTopLevelEntry = cursor.advance();
     if (!maybeTopLevelEntry)
@@ -476,12 +607,32 @@ Error SDKDBBitcodeReader::Implementation::validateSDKDB() {
       break;
     }
 
+    case IDENTIFIER_BLOCK_ID: {
+      if (auto err = readIdentificationBlock(cursor))
+        return err;
+      break;
+    }
+
     case SDKDB_BLOCK_ID: {
+      if (!sdkdbBlockStart)
+        sdkdbBlockStart = cursor.GetCurrentBitNo();
       if (auto err = readTripleFromSDKDB(cursor))
         return err;
       break;
     }
 
+    case LIBRARY_TABLE_BLOCK_ID: {
+      if (auto err = readLibraryTableBlock(cursor))
+        return err;
+      break;
+    }
+
+    case SYMBOL_TABLE_BLOCK_ID: {
+      if (auto err = readSymbolTableBlock(cursor))
+        return err;
+      break;
+    }
+
     default: { // Skip all the other blocks.
       if (auto err = cursor.SkipBlock())
         return err;
@@ -501,6 +652,8 @@ SDKDBBitcodeReader::Implementation::readAPIBlock(BitstreamCursor &cursor,
 
   bool skipBlock = !option.installNames.empty();
   API api(sdkdb.getTargetTriple());
+  std::optional<uint64_t> contentHash;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -588,6 +741,9 @@ SDKDBBitcodeReader::Implementation::readAPIBlock(BitstreamCursor &cursor,
           return sym.takeError();
         continue;
       }
+      case api_block::CONTENT_HASH:
+        contentHash = scratch[0] | (scratch[1] << 32);
+        continue;
       default:
         // Unknown record, possibly for use by a future version of the  format.
         continue;
@@ -632,15 +788,18 @@ SDKDBBitcodeReader::Implementation::readAPIBlock(BitstreamCursor &cursor,
       }
     }
     case BitstreamEntry::EndBlock:
-      if (!skipBlock)
-        return &sdkdb.recordAPI(std::move(api));
-      return nullptr;
+      if (skipBlock)
+        return nullptr;
+      if (contentHash)
+        sdkdb.setContentHash(api.getBinaryInfo().installName, *contentHash);
+      return &sdkdb.recordAPI(std::move(api));
     }
   }
 }
 
 Expected<APIRecord>
-SDKDBBitcodeReader::Implementation::readAPIRecordFromScratch() const {
+SDKDBBitcodeReader::Implementation::readAPIRecordFromScratch(
+    ArrayRef<uint64_t> scratch) const {
   if (scratch.size() < 5)
     return make_error<StringError>("scratch entry is too small for APIRecord",
                                    inconvertibleErrorCode());
@@ -670,7 +829,7 @@ SDKDBBitcodeReader::Implementation::readAPIRecordFromScratch() const {
 }
 
 Error SDKDBBitcodeReader::Implementation::readAvailabilityInfoFromScratch(
-    APIRecord &record) const {
+    ArrayRef<uint64_t> scratch, APIRecord &record) const {
   if (scratch.size() < 4)
     return make_error<StringError>(
         "scratch entry is too small for availability",
@@ -682,7 +841,7 @@ Error SDKDBBitcodeReader::Implementation::readAvailabilityInfoFromScratch(
 }
 
 Error SDKDBBitcodeReader::Implementation::readFilenameFromScratch(
-    APIRecord &record) const {
+    ArrayRef<uint64_t> scratch, APIRecord &record) const {
   if (scratch.size() < 2)
     return make_error<StringError>("scratch entry is too small for filename",
                                    inconvertibleErrorCode());
@@ -696,7 +855,7 @@ Error SDKDBBitcodeReader::Implementation::readFilenameFromScratch(
 }
 
 Error SDKDBBitcodeReader::Implementation::readSourceLocationFromScratch(
-    APIRecord &record) const {
+    ArrayRef<uint64_t> scratch, APIRecord &record) const {
   if (scratch.size() < 2)
     return make_error<StringError>("scratch entry is too small for line & col",
                                    inconvertibleErrorCode());
@@ -710,6 +869,7 @@ Error SDKDBBitcodeReader::Implementation::readGlobalBlock(
     return err;
 
   GlobalRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -731,7 +891,7 @@ Error SDKDBBitcodeReader::Implementation::readGlobalBlock(
                                        inconvertibleErrorCode());
       switch (kind) {
       case global_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         record = api.addGlobal(
@@ -741,17 +901,17 @@ Error SDKDBBitcodeReader::Implementation::readGlobalBlock(
         continue;
       }
       case global_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case global_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case global_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -778,6 +938,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCClassBlock(
     return err;
 
   ObjCInterfaceRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -800,7 +961,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCClassBlock(
             inconvertibleErrorCode());
       switch (kind) {
       case objc_class_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         unsigned offset = scratch[5];
@@ -822,17 +983,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCClassBlock(
         continue;
       }
       case objc_class_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_class_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_class_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -888,6 +1049,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCCategoryBlock(
     return err;
 
   ObjCCategoryRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -910,7 +1072,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCCategoryBlock(
             inconvertibleErrorCode());
       switch (kind) {
       case objc_category_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         unsigned offset = scratch[5];
@@ -925,17 +1087,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCCategoryBlock(
         continue;
       }
       case objc_category_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_category_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_category_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -991,6 +1153,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCProtocolBlock(
     return err;
 
   ObjCProtocolRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1013,7 +1176,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCProtocolBlock(
             inconvertibleErrorCode());
       switch (kind) {
       case objc_protocol_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         record = api.addObjCProtocol(apiRecord->name, apiRecord->loc,
@@ -1022,17 +1185,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCProtocolBlock(
         continue;
       }
       case objc_protocol_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_protocol_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_protocol_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1088,6 +1251,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCMethodBlock(
     return err;
 
   ObjCMethodRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1109,7 +1273,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCMethodBlock(
                                        inconvertibleErrorCode());
       switch (kind) {
       case objc_method_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         record = api.addObjCMethod(&container, apiRecord->name, apiRecord->loc,
@@ -1120,17 +1284,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCMethodBlock(
         continue;
       }
       case objc_method_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_method_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_method_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1157,6 +1321,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCPropertyBlock(
     return err;
 
   ObjCPropertyRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1179,7 +1344,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCPropertyBlock(
             inconvertibleErrorCode());
       switch (kind) {
       case objc_property_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         auto getter = readStringFromTable(scratch[7], scratch[8]);
@@ -1196,17 +1361,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCPropertyBlock(
         continue;
       }
       case objc_property_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_property_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_property_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1233,6 +1398,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCInstanceVarBlock(
     return err;
 
   ObjCInstanceVariableRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1254,7 +1420,7 @@ Error SDKDBBitcodeReader::Implementation::readObjCInstanceVarBlock(
                                        inconvertibleErrorCode());
       switch (kind) {
       case objc_ivar_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         // Do not emit an error, because old SDKDB formats are broken and don't
@@ -1270,17 +1436,17 @@ Error SDKDBBitcodeReader::Implementation::readObjCInstanceVarBlock(
         continue;
       }
       case objc_ivar_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_ivar_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case objc_ivar_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1307,6 +1473,7 @@ Error SDKDBBitcodeReader::Implementation::readEnumBlock(BitstreamCursor &cursor,
     return err;
 
   EnumRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1328,7 +1495,7 @@ Error SDKDBBitcodeReader::Implementation::readEnumBlock(BitstreamCursor &cursor,
                                        inconvertibleErrorCode());
       switch (kind) {
       case enum_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         unsigned offset = scratch[5];
@@ -1343,17 +1510,17 @@ Error SDKDBBitcodeReader::Implementation::readEnumBlock(BitstreamCursor &cursor,
         continue;
       }
       case enum_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case enum_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case enum_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1391,6 +1558,7 @@ Error SDKDBBitcodeReader::Implementation::readEnumConstantBlock(
     return err;
 
   APIRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1413,7 +1581,7 @@ Error SDKDBBitcodeReader::Implementation::readEnumConstantBlock(
             inconvertibleErrorCode());
       switch (kind) {
       case enum_constant_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         record = api.addEnumConstant(parent, apiRecord->name, apiRecord->loc,
@@ -1422,17 +1590,17 @@ Error SDKDBBitcodeReader::Implementation::readEnumConstantBlock(
         continue;
       }
       case enum_constant_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case enum_constant_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case enum_constant_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1459,6 +1627,7 @@ Error SDKDBBitcodeReader::Implementation::readTypedefBlock(
     return err;
 
   APIRecord *record = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1480,7 +1649,7 @@ Error SDKDBBitcodeReader::Implementation::readTypedefBlock(
                                        inconvertibleErrorCode());
       switch (kind) {
       case typedef_block::INFO: {
-        auto apiRecord = readAPIRecordFromScratch();
+        auto apiRecord = readAPIRecordFromScratch(scratch);
         if (!apiRecord)
           return apiRecord.takeError();
         record = api.addTypeDef(apiRecord->name, apiRecord->loc,
@@ -1489,17 +1658,17 @@ Error SDKDBBitcodeReader::Implementation::readTypedefBlock(
         continue;
       }
       case typedef_block::AVAILABILITY: {
-        if (auto err = readAvailabilityInfoFromScratch(*record))
+        if (auto err = readAvailabilityInfoFromScratch(scratch, *record))
           return err;
         continue;
       }
       case typedef_block::FILENAME: {
-        if (auto err = readFilenameFromScratch(*record))
+        if (auto err = readFilenameFromScratch(scratch, *record))
           return err;
         continue;
       }
       case typedef_block::LOCATION: {
-        if (auto err = readSourceLocationFromScratch(*record))
+        if (auto err = readSourceLocationFromScratch(scratch, *record))
           return err;
         continue;
       }
@@ -1527,6 +1696,7 @@ Error SDKDBBitcodeReader::Implementation::readSDKDBBlock(
 
   bool skipBlock = false;
   SDKDB *db = nullptr;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1593,7 +1763,7 @@ Error SDKDBBitcodeReader::Implementation::readSDKDBBlock(
 Error SDKDBBitcodeReader::Implementation::materialize(
     SDKDBBuilder &builder) const {
   BitstreamCursor cursor(input);
-  BitstreamBlockInfo blockInfo;
+  cursor.setBlockInfo(&blockInfo);
 
   // set build version.
   builder.setBuildVersion(buildVersion);
@@ -1616,23 +1786,11 @@ Error SDKDBBitcodeReader::Implementation::materialize(
       break;
 
     switch (topLevelEntry.ID) {
-    case bitc::BLOCKINFO_BLOCK_ID: {
-      if (auto err = readBlockInfoBlock(cursor, blockInfo))
-        return err;
-
-      break;
-    }
-
     case SDKDB_BLOCK_ID: {
       if (auto err = readSDKDBBlock(cursor, builder))
         return err;
       break;
     }
-    case IDENTIFIER_BLOCK_ID: {
-      if (auto err = readIdentificationBlock(cursor))
-        return err;
-      break;
-    }
 
     default: { // Skip all the other blocks.
       if (auto err = cursor.SkipBlock())
@@ -1647,62 +1805,19 @@ Error SDKDBBitcodeReader::Implementation::materialize(
 
 Expected<bool>
 SDKDBBitcodeReader::Implementation::dylibExistsForPath(Triple &target,
-                                                       StringRef path) {
-  auto result = findOffsetForLibrary(target, path);
-
-  if (!result)
-    return result.takeError();
-
-  return *result;
+                                                       StringRef path) const {
+  return findOffsetForLibrary(target, path) != 0;
 }
 
 Error SDKDBBitcodeReader::Implementation::loadAPIsFromSDKDB(
-    SDKDBBuilder &builder, Triple &target, StringRef path) {
-  // Create cursor and parse BlockInfo block.
-  BitstreamCursor cursor(input);
-  BitstreamBlockInfo blockInfo;
-  uint64_t sdkdbBlockStart = 0;
-
-  if (auto err = readSignature(cursor))
-    return err;
-
-  while (!cursor.AtEndOfStream()) {
-    auto maybeTopLevelEntry = cursor.advance();
-    if (!maybeTopLevelEntry)
-      return maybeTopLevelEntry.takeError();
-
-    auto topLevelEntry = maybeTopLevelEntry.get();
-    if (topLevelEntry.Kind != BitstreamEntry::SubBlock)
-      break;
-
-    switch (topLevelEntry.ID) {
-    case bitc::BLOCKINFO_BLOCK_ID: {
-      if (auto err = readBlockInfoBlock(cursor, blockInfo))
-        return err;
-
-      break;
-    }
-    case SDKDB_BLOCK_ID: {
-      sdkdbBlockStart = cursor.GetCurrentBitNo();
-      if (auto err = cursor.SkipBlock())
-        return err;
-      break;
-    }
-    case IDENTIFIER_BLOCK_ID: {
-      if (auto err = readIdentificationBlock(cursor))
-        return err;
-      break;
-    }
-    default: { // Skip all the other blocks.
-      if (auto err = cursor.SkipBlock())
-        return err;
-      break;
-    }
-    }
-  }
+    SDKDBBuilder &builder, Triple &target, StringRef path) const {
+  if (!sdkdbBlockStart)
+    return make_error<StringError>("SDKDB has no SDKDB block",
+                                   inconvertibleErrorCode());
 
-  // reset the cursor to the beginning of SDKDB block so we can enter its
-  // context.
+  // Enter the SDKDB block context, so the cursor can jump to the libraries.
+  BitstreamCursor cursor(input);
+  cursor.setBlockInfo(&blockInfo);
   if (auto err = cursor.JumpToBit(sdkdbBlockStart))
     return err;
 
@@ -1725,13 +1840,10 @@ Error SDKDBBitcodeReader::Implementation::loadAPIsFromSDKDB(
 
     auto offset = findOffsetForLibrary(target, current);
     if (!offset)
-      return offset.takeError();
-
-    if (!*offset)
       return make_error<StringError>("Dylib not found in SDKDB",
                                     inconvertibleErrorCode());
 
-    if (auto err = cursor.JumpToBit(*offset))
+    if (auto err = cursor.JumpToBit(offset))
       return err;
 
     auto maybeAPIEntry = cursor.advance();
@@ -1760,61 +1872,13 @@ Error SDKDBBitcodeReader::Implementation::loadAPIsFromSDKDB(
   return Error::success();
 }
 
-Error SDKDBBitcodeReader::Implementation::materializeLibraryTable() const {
-  // Done if dylibTable is already populated.
-  if (!dylibTable.empty())
-    return Error::success();
-
-  BitstreamCursor cursor(input);
-  BitstreamBlockInfo blockInfo;
-
-  if (auto err = readSignature(cursor))
-    return err;
-
-  while (!cursor.AtEndOfStream()) {
-    auto maybeTopLevelEntry = cursor.advance();
-    if (!maybeTopLevelEntry)
-      return maybeTopLevelEntry.takeError();
-
-    auto topLevelEntry = maybeTopLevelEntry.get();
-    if (topLevelEntry.Kind != BitstreamEntry::SubBlock)
-      break;
-
-    switch (topLevelEntry.ID) {
-    case bitc::BLOCKINFO_BLOCK_ID: {
-      if (auto err = readBlockInfoBlock(cursor, blockInfo))
-        return err;
-
-      break;
-    }
-    case IDENTIFIER_BLOCK_ID: {
-      if (auto err = readIdentificationBlock(cursor))
-        return err;
-      break;
-    }
-    case LIBRARY_TABLE_BLOCK_ID: {
-      if (auto err = readLibraryTableBlock(cursor))
-        return err;
-      break;
-    }
-
-    default: { // Skip all the other blocks.
-      if (auto err = cursor.SkipBlock())
-        return err;
-      break;
-    }
-    }
-  }
-
-  return Error::success();
-}
-
 Error SDKDBBitcodeReader::Implementation::readLibraryTableBlock(
-    BitstreamCursor &cursor) const {
+    BitstreamCursor &cursor) {
   if (auto err = cursor.EnterSubBlock(LIBRARY_TABLE_BLOCK_ID))
     return err;
 
   Triple target;
+  SmallVector<uint64_t, 64> scratch;
   while (true) {
     auto maybeEntry = cursor.advance();
     if (!maybeEntry)
@@ -1862,12 +1926,82 @@ Error SDKDBBitcodeReader::Implementation::readLibraryTableBlock(
   } // while
 }
 
-Expected<uint64_t>
-SDKDBBitcodeReader::Implementation::getOffsetForLibrary(Triple &target,
-                                                        StringRef path) {
-  if (auto err = materializeLibraryTable())
-    return std::move(err);
+Error SDKDBBitcodeReader::Implementation::readSymbolTableBlock(
+    BitstreamCursor &cursor) {
+  if (auto err = cursor.EnterSubBlock(SYMBOL_TABLE_BLOCK_ID))
+    return err;
+
+  Triple target;
+  SmallVector<uint64_t, 64> scratch;
+  while (true) {
+    auto maybeEntry = cursor.advance();
+    if (!maybeEntry)
+      return maybeEntry.takeError();
+    auto entry = maybeEntry.get();
 
+    switch (entry.Kind) {
+    case BitstreamEntry::Error:
+      return make_error<StringError>("error malformed entry",
+                                     inconvertibleErrorCode());
+    case BitstreamEntry::Record: {
+      scratch.clear();
+      StringRef blob;
+      auto maybeKind = cursor.readRecord(entry.ID, scratch, &blob);
+      if (!maybeKind)
+        return maybeKind.takeError();
+      unsigned kind = maybeKind.get();
+      switch (kind) {
+      case symbol_table_block::TARGET_TRIPLE: {
+        target = Triple(blob);
+        continue;
+      }
+      case symbol_table_block::LOOKUP_TABLE: {
+        uint64_t tableOffset = scratch[0];
+        auto base = reinterpret_cast<const uint8_t *>(blob.data());
+        SymbolTableInfo info(stringTable.data());
+        std::unique_ptr<SerializedSymbolTable> table(
+            SerializedSymbolTable::Create(base + tableOffset, base, info));
+
+        symbolTable.try_emplace(target.str(), std::move(table));
+        continue;
+      }
+      default:
+        continue;
+      }
+    }
+    case BitstreamEntry::SubBlock:
+      return make_error<StringError>("No subblocks in SYMBOL_TABLE",
+                                     inconvertibleErrorCode());
+    case BitstreamEntry::EndBlock:
+      return Error::success();
+    }
+  } // while
+}
+
+Expected<std::vector<SDKDBSymbolTableEntry>>
+SDKDBBitcodeReader::Implementation::lookupSymbol(const Triple &target,
+                                                 StringRef name) const {
+  if (!hasSymbolTable())
+    return make_error<StringError>("SDKDB has no symbol table",
+                                   inconvertibleErrorCode());
+
+  for (auto &entry : symbolTable) {
+    if (target != Triple(entry.getKey()))
+      continue;
+
+    auto symbol = entry.getValue()->find(name);
+    if (symbol != entry.getValue()->end())
+      return *symbol;
+
+    break;
+  }
+
+  return std::vector<SDKDBSymbolTableEntry>();
+}
+
+uint64_t
+SDKDBBitcodeReader::Implementation::getOffsetForLibrary(const Triple &target,
+                                                        StringRef path) const {
   for (auto &entry : dylibTable) {
     if (target != Triple(entry.getKey()))
       continue;
@@ -1882,15 +2016,12 @@ SDKDBBitcodeReader::Implementation::getOffsetForLibrary(Triple &target,
   return 0;
 }
 
-Expected<uint64_t>
-SDKDBBitcodeReader::Implementation::findOffsetForLibrary(Triple &target,
-                                                         StringRef path) {
+uint64_t
+SDKDBBitcodeReader::Implementation::findOffsetForLibrary(const Triple &target,
+                                                         StringRef path) const {
   auto offset = getOffsetForLibrary(target, path);
-  if (!offset)
-    return offset.takeError();
-
-  if (*offset)
-    return *offset;
+  if (offset)
+    return offset;
 
   // NOTE: Not all dylibs and frameworks are zippered correctly.
   // This is the workaround to load macOS version of the dylib.
@@ -1899,13 +2030,11 @@ SDKDBBitcodeReader::Implementation::findOffsetForLibrary(Triple &target,
     macTarget.setOS(Triple::MacOSX);
     macTarget.setEnvironmentName("");
     offset = getOffsetForLibrary(macTarget, path);
-    if (!offset)
-      return offset.takeError();
-    if (*offset)
+    if (offset)
       errs() << "warning: fallback to macOS to find " + path << "\n";
   }
 
-  return *offset;
+  return offset;
 }
 
 Expected<StringRef>
@@ -77,6 +77,77 @@ public:
     writer.write<data_type>(data);
   }
 };
+
+/// A library that exports a symbol.
+struct SymbolTableEntry {
+  StringRef installName;
+  uint64_t libraryOffset;
+  AvailabilityInfo availability;
+  APIAccess access;
+  APILinkage linkage;
+};
+
+using SymbolTable = StringMap<SmallVector<SymbolTableEntry, 1>>;
+
+/// Used to serialize the on-disk symbol table.
+class SymbolTableInfo {
+  StringTableBuilder &stringTable;
+
+public:
+  SymbolTableInfo(StringTableBuilder &stringTable)
+      : stringTable(stringTable) {}
+
+  using key_type = StringRef;
+  using key_type_ref = const key_type &;
+  using data_type = SmallVector<SymbolTableEntry, 1>;
+  using data_type_ref = const data_type &;
+  using hash_value_type = uint64_t;
+  using offset_type = unsigned;
+
+  // InstallName: offset=32 length=16. Library block: offset=64.
+  // Availability: introduced=32 obsoleted=32 flags=8. Access=8 linkage=8.
+  static constexpr offset_type entryLength = 4 + 2 + 8 + 4 + 4 + 1 + 1 + 1;
+
+  // NOLINTNEXTLINE
+  hash_value_type ComputeHash(key_type_ref key) { return hash_value(key); }
+
+  std::pair<offset_type, offset_type> // NOLINTNEXTLINE
+  EmitKeyDataLength(raw_ostream &out, key_type_ref key, data_type_ref data) {
+    // StringRef: offset=32 length=16.
+    offset_type keyLength = sizeof(uint32_t) + sizeof(uint16_t);
+    // The number of libraries varies, so only the data length is emitted.
+    offset_type dataLength = data.size() * entryLength;
+    support::endian::Writer writer(out, support::little);
+    writer.write<uint32_t>(dataLength);
+    return {keyLength, dataLength};
+  }
+
+  // NOLINTNEXTLINE
+  void EmitKey(raw_ostream &out, key_type_ref key, offset_type len) {
+    unsigned keyOffset = stringTable.getOffset(key);
+    unsigned keySize = key.size();
+    support::endian::Writer writer(out, support::little);
+    writer.write<uint32_t>(keyOffset);
+    writer.write<uint16_t>(keySize);
+  }
+
+  // NOLINTNEXTLINE
+  void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                offset_type len) {
+    support::endian::Writer writer(out, support::little);
+    for (const auto &entry : data) {
+      writer.write<uint32_t>(stringTable.getOffset(entry.installName));
+      writer.write<uint16_t>(entry.installName.size());
+      writer.write<uint64_t>(entry.libraryOffset);
+      writer.write<uint32_t>(entry.availability._introduced.rawValue());
+      writer.write<uint32_t>(entry.availability._obsoleted.rawValue());
+      writer.write<uint8_t>(entry.availability._unavailable |
+                            entry.availability._isSPIAvailable << 1);
+      writer.write<uint8_t>((uint8_t)entry.access);
+      writer.write<uint8_t>((uint8_t)entry.linkage);
+    }
+  }
+};
 } // end anonymous namespace
 
 class SDKDBWriter {
@@ -95,6 +166,7 @@ private:
   void writeAPIBlock(const API& api);
   void writeBinaryInfoBlock(const BinaryInfo &info);
   void writeLibraryTable();
+  void writeSymbolTable();
 
   std::optional<StringRef> getShallowFrameworkPath(StringRef installName);
 
@@ -116,6 +188,9 @@ private:
   Triple currentTriple;
   uint64_t currentAPIStart;
   StringMap<StringMap<uint64_t>> libraryIndex;
+
+  /// Table for building symbol index. [triple][symbol] -> libraries
+  StringMap<SymbolTable> symbolIndex;
 };
 
 // This is a list of hard coded install_name path -> symlinked location.
@@ -193,6 +268,7 @@ enum {
   API_SWIFT_VERSION_ABBREV,
   API_POTENTIALLY_DEFINED_SELECTOR_ABBREV,
   API_PROJECT_NAME_ABBREV,
+  API_CONTENT_HASH_ABBREV,
 
   // GLOBAL_BLOCK abbrev id's.
   GLOBAL_INFO_ABBREV = bitc::FIRST_APPLICATION_ABBREV,
@@ -243,6 +319,10 @@ enum {
   LIBRARY_TABLE_TARGET_TRIPLE_ABBREV = bitc::FIRST_APPLICATION_ABBREV,
   LIBRARY_TABLE_LOOKUP_TABLE_ABBREV,
 
+  // SYMBOL_TABLE_BLOCK abbrev id's
+  SYMBOL_TABLE_TARGET_TRIPLE_ABBREV = bitc::FIRST_APPLICATION_ABBREV,
+  SYMBOL_TABLE_LOOKUP_TABLE_ABBREV,
+
   // ENUM_BLOCK abbrev id's.
   ENUM_INFO_ABBREV = bitc::FIRST_APPLICATION_ABBREV,
   ENUM_AVAILABILITY_ABBREV,
@@ -327,9 +407,11 @@ class APISerializer : public APIVisitor {
 public:
   APISerializer(BitstreamWriter &writer, StringTableBuilder &table,
                 uint64_t currentAPIStart, StringMap<uint64_t> &libraryIndex,
+                SymbolTable *symbolTable, StringRef installName,
                 const SDKDBBuilder &builder)
       : writer(writer), stringBuilder(table), currentAPIStart(currentAPIStart),
-        libraryIndex(libraryIndex), builder(builder) {}
+        libraryIndex(libraryIndex), symbolTable(symbolTable),
+        installName(installName), builder(builder) {}
 
   void visitGlobal(const GlobalRecord &record) override;
 
@@ -362,6 +444,9 @@ private:
   StringTableBuilder &stringBuilder;
   uint64_t currentAPIStart;
   StringMap<uint64_t> &libraryIndex;
+  /// Symbol table to add the exported globals to, if one is emitted.
+  SymbolTable *symbolTable;
+  StringRef installName;
   const SDKDBBuilder &builder;
   /// Scratch space.
   SmallVector<uint64_t, 64> scratchRecord;
@@ -422,6 +507,8 @@ void SDKDBWriter::writeToStream(raw_ostream &os) {
   for (auto *db : builder.getDatabases())
     writeSDKDBBlock(*db);
   writeLibraryTable();
+  if (builder.hasSymbolTable())
+    writeSymbolTable();
 
   // Write the buffer to the stream.
   os.write(buffer.data(), buffer.size());
@@ -614,6 +701,10 @@ void SDKDBWriter::writeBlockInfoBlock() {
   BLOCK_RECORD(typedef_block, AVAILABILITY);
   BLOCK_RECORD(typedef_block, FILENAME);
   BLOCK_RECORD(typedef_block, LOCATION);
+
+  BLOCK(SYMBOL_TABLE_BLOCK);
+  BLOCK_RECORD(symbol_table_block, TARGET_TRIPLE);
+  BLOCK_RECORD(symbol_table_block, LOOKUP_TABLE);
 #undef BLOCK
 #undef BLOCK_RECORD
 
@@ -734,6 +825,16 @@ void SDKDBWriter::writeBlockInfoBlock() {
         API_PROJECT_NAME_ABBREV)
       llvm_unreachable("Unexpected abbrev ordering!");
   }
+  { // Content hash.
+    auto abbv = std::make_shared<BitCodeAbbrev>();
+    abbv->Add(BitCodeAbbrevOp(api_block::CONTENT_HASH));
+    // Low and high 32 bits of the hash.
+    abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+    abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+    if (writer->EmitBlockInfoAbbrev(API_BLOCK_ID, abbv) !=
+        API_CONTENT_HASH_ABBREV)
+      llvm_unreachable("Unexpected abbrev ordering!");
+  }
   // Global Entry.
   {
     // INFO.
@@ -960,6 +1061,27 @@ void SDKDBWriter::writeBlockInfoBlock() {
     addLocationAbbrev(*writer, typedef_block::LOCATION, TYPEDEF_BLOCK_ID,
                       TYPEDEF_LOCATION_ABBREV);
   }
+  // Symbol table lookup entry.
+  { // Target Triple.
+    auto abbv = std::make_shared<BitCodeAbbrev>();
+    abbv->Add(BitCodeAbbrevOp(symbol_table_block::TARGET_TRIPLE));
+    // Target triple.
+    abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    if (writer->EmitBlockInfoAbbrev(SYMBOL_TABLE_BLOCK_ID, abbv) !=
+        SYMBOL_TABLE_TARGET_TRIPLE_ABBREV)
+      llvm_unreachable("Unexpected abbrev ordering!");
+  }
+  { // Lookup table
+    auto abbv = std::make_shared<BitCodeAbbrev>();
+    abbv->Add(BitCodeAbbrevOp(symbol_table_block::LOOKUP_TABLE));
+    // Size
+    abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
+    // Data
+    abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    if (writer->EmitBlockInfoAbbrev(SYMBOL_TABLE_BLOCK_ID, abbv) !=
+        SYMBOL_TABLE_LOOKUP_TABLE_ABBREV)
+      llvm_unreachable("Unexpected abbrev ordering!");
+  }
 }
 
 void SDKDBWriter::writeControlBlock() {
@@ -986,7 +1108,12 @@ void SDKDBWriter::writeControlBlock() {
   auto projectAbbrevCode = writer->EmitAbbrev(std::move(projectAbbrev));
 
   // METADATA
-  scratchRecord = {control_block::METADATA, VERSION_MAJOR, VERSION_MINOR,
+  // Only claim the new minor version if the file needs it, so older readers
+  // can still load binary stores without a symbol table.
+  uint16_t minorVersion = builder.hasSymbolTable()
+                              ? VERSION_MINOR
+                              : VERSION_MINOR_NO_SYMBOL_TABLE;
+  scratchRecord = {control_block::METADATA, VERSION_MAJOR, minorVersion,
                    builder.getRawOptionEncoding()};
   writer->EmitRecordWithBlob(metadataAbbrevCode, scratchRecord,
                              builder.getBuildVersion());
@@ -1048,8 +1175,23 @@ void SDKDBWriter::writeAPIBlock(const API& api) {
   if (api.hasBinaryInfo())
     writeBinaryInfoBlock(api.getBinaryInfo());
 
+  // Record the content hash of the library, so compare can tell which
+  // libraries didn't change between two SDKDBs.
+  if (api.hasBinaryInfo() && !api.getBinaryInfo().installName.empty()) {
+    uint64_t hash = builder.computeContentHash(api);
+    scratchRecord = {api_block::CONTENT_HASH, hash & 0xffffffff, hash >> 32};
+    writer->EmitRecordWithAbbrev(API_CONTENT_HASH_ABBREV, scratchRecord);
+  }
+
+  StringRef installName =
+      api.hasBinaryInfo() ? api.getBinaryInfo().installName : StringRef();
+  SymbolTable *symbolTable = nullptr;
+  if (builder.hasSymbolTable() && !installName.empty())
+    symbolTable = &symbolIndex[currentTriple.str()];
+
   APISerializer serializer(*writer, stringBuilder, currentAPIStart,
-                           libraryIndex[currentTriple.str()], builder);
+                           libraryIndex[currentTriple.str()], symbolTable,
+                           installName, builder);
   api.visit(serializer);
 
   // potentially defined selectors.
@@ -1153,6 +1295,33 @@ void SDKDBWriter::writeLibraryTable() {
   }
 }
 
+void SDKDBWriter::writeSymbolTable() {
+  // Write symbol lookup table, one block each target.
+  SmallString<4096> hashTableBlob;
+  for (auto &entry : symbolIndex) {
+    BCBlockRAII restoreBlock(*writer, SYMBOL_TABLE_BLOCK_ID, /*abbrevLen=*/3);
+    // Write target triple.
+    scratchRecord = {symbol_table_block::TARGET_TRIPLE};
+    writer->EmitRecordWithBlob(SYMBOL_TABLE_TARGET_TRIPLE_ABBREV,
+                               scratchRecord, entry.getKey());
+
+    // Generate onDisk hash table for table.
+    OnDiskChainedHashTableGenerator<SymbolTableInfo> generator;
+    SymbolTableInfo info(stringBuilder);
+    for (auto &symbol : entry.getValue())
+      generator.insert(symbol.getKey(), symbol.getValue(), info);
+
+    hashTableBlob.clear();
+    raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    support::endian::write<uint64_t>(blobStream, 0, support::little);
+    auto tableOffset = generator.Emit(blobStream, info);
+    scratchRecord = {symbol_table_block::LOOKUP_TABLE, tableOffset};
+    writer->EmitRecordWithBlob(SYMBOL_TABLE_LOOKUP_TABLE_ABBREV, scratchRecord,
+                               hashTableBlob);
+  }
+}
+
 void APICollector::processAPIRecord(const APIRecord &record) {
   if (builder.isPublicOnly() && (record.access < APIAccess::Public))
     return;
@@ -1195,6 +1364,12 @@ void APISerializer::visitGlobal(const GlobalRecord &record) {
   // Using try_emplace here to not overwriting any value if already exists.
   if (auto name = getPreviousInstallName(record.name))
     libraryIndex.try_emplace(*name, currentAPIStart);
+
+  // Index the exported symbols by name.
+  if (symbolTable && record.linkage >= APILinkage::Reexported)
+    (*symbolTable)[record.name].push_back({installName, currentAPIStart,
+                                           record.availability, record.access,
+                                           record.linkage});
 }
 
 void APISerializer::visitObjCInterface(const ObjCInterfaceRecord &record) {
@@ -12,7 +12,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "tapi/Core/APIJSONSerializer.h"
+#include "tapi/Core/APIVisitor.h"
 #include "tapi/SDKDB/PartialSDKDB.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/LEB128.h"
 
 using namespace llvm;
 
@@ -193,4 +197,704 @@ Error PartialSDKDB::serialize(
   return Error::success();
 }
 
+// The binary partial SDKDB is a flat stream of ULEB128 numbers and strings:
+//
+//   magic, version, flags, projectName,
+//   RuntimeRoot, PublicSDKContentRoot, SDKContentRoot
+//
+// Each root is a count followed by that many APIs. The public roots come
+// before SDKContentRoot, so reading the public APIs can stop early. Every
+// string is written once; a string reference of 0 is followed by the length
+// and bytes of a new string, and any other value N refers back to the
+// (N-1)th string in the stream.
+namespace {
+
+constexpr StringLiteral binaryMagic = "TAPIPSDB";
+constexpr uint64_t binaryVersion = 1;
+
+enum BinaryFlags : uint64_t {
+  HasErrors = 1U << 0,
+};
+
+enum RecordBits : uint64_t {
+  HasLocation = 1U << 0,
+  HasIntroduced = 1U << 1,
+  HasObsoleted = 1U << 2,
+  IsUnavailable = 1U << 3,
+  IsSPIAvailable = 1U << 4,
+  IsWeakDefined = 1U << 5,
+  IsWeakReferenced = 1U << 6,
+  IsThreadLocalValue = 1U << 7,
+  IsInstanceMethod = 1U << 8,
+  IsOptional = 1U << 9,
+  IsDynamic = 1U << 10,
+  HasException = 1U << 11,
+};
+
+enum BinaryInfoBits : uint64_t {
+  IsTwoLevelNamespace = 1U << 0,
+  IsAppExtensionSafe = 1U << 1,
+};
+
+enum class BinaryFileType : uint64_t {
+  Invalid = 0,
+  DynamicLibrary = 1,
+  DynamicLibraryStub = 2,
+  Bundle = 3,
+};
+
+// Collects the records that the JSON format would write, in visit order.
+class BinaryRecordCollector : public APIVisitor {
+public:
+  void visitGlobal(const GlobalRecord &record) override {
+    // Hidden globals are dropped, the same as with noHiddenGlobal in JSON.
+    if (!record.isExported() && !record.inlined)
+      return;
+    globals.emplace_back(&record);
+  }
+  void visitEnum(const EnumRecord &record) override {
+    enums.emplace_back(&record);
+  }
+  void visitObjCInterface(const ObjCInterfaceRecord &record) override {
+    interfaces.emplace_back(&record);
+  }
+  void visitObjCCategory(const ObjCCategoryRecord &record) override {
+    categories.emplace_back(&record);
+  }
+  void visitObjCProtocol(const ObjCProtocolRecord &record) override {
+    protocols.emplace_back(&record);
+  }
+  void visitTypeDef(const TypedefRecord &record) override {
+    typedefs.emplace_back(&record);
+  }
+
+  std::vector<const GlobalRecord *> globals;
+  std::vector<const EnumRecord *> enums;
+  std::vector<const ObjCInterfaceRecord *> interfaces;
+  std::vector<const ObjCCategoryRecord *> categories;
+  std::vector<const ObjCProtocolRecord *> protocols;
+  std::vector<const TypedefRecord *> typedefs;
+};
+
+class BinaryPartialSDKDBWriter {
+public:
+  BinaryPartialSDKDBWriter(raw_ostream &os) : os(os) {}
+
+  void writeHeader(StringRef project, bool hasErrors) {
+    os << binaryMagic;
+    writeNumber(binaryVersion);
+    writeNumber(hasErrors ? HasErrors : 0);
+    writeString(project);
+  }
+
+  void writeRoot(ArrayRef<const API *> apis) {
+    writeNumber(apis.size());
+    for (const auto *api : apis)
+      writeAPI(*api);
+  }
+
+private:
+  void writeNumber(uint64_t value) { encodeULEB128(value, os); }
+
+  void writeString(StringRef str) {
+    auto result = strings.try_emplace(str, strings.size());
+    if (!result.second) {
+      writeNumber(result.first->second + 1);
+      return;
+    }
+    writeNumber(0);
+    writeNumber(str.size());
+    os << str;
+  }
+
+  void writeStrings(ArrayRef<StringRef> strs) {
+    writeNumber(strs.size());
+    for (auto str : strs)
+      writeString(str);
+  }
+
+  void writeRecord(const APIRecord &record, uint64_t bits = 0) {
+    const auto &avail = record.availability;
+    if (!record.loc.isInvalid())
+      bits |= HasLocation;
+    if (!avail.isDefault()) {
+      if (avail._introduced != PackedVersion())
+        bits |= HasIntroduced;
+      if (avail._obsoleted != PackedVersion())
+        bits |= HasObsoleted;
+      if (avail.isUnavailable())
+        bits |= IsUnavailable;
+      if (avail.isSPIAvailable())
+        bits |= IsSPIAvailable;
+    }
+    if (record.isWeakDefined())
+      bits |= IsWeakDefined;
+    if (record.isWeakReferenced())
+      bits |= IsWeakReferenced;
+    if (record.isThreadLocalValue())
+      bits |= IsThreadLocalValue;
+
+    writeString(record.name);
+    writeNumber(bits);
+    if (bits & HasLocation)
+      writeString(record.loc.getFilename());
+    if (bits & HasIntroduced)
+      writeNumber(avail._introduced.rawValue());
+    if (bits & HasObsoleted)
+      writeNumber(avail._obsoleted.rawValue());
+    writeNumber(static_cast<uint64_t>(record.linkage));
+    writeNumber(static_cast<uint64_t>(record.access));
+  }
+
+  void writeContainerMembers(const ObjCContainerRecord &record) {
+    writeStrings(record.protocols);
+
+    // Instance methods are written before class methods, which is the order
+    // the JSON parser adds them in.
+    std::vector<const ObjCMethodRecord *> methods;
+    for (const auto *method : record.methods)
+      if (method->isInstanceMethod)
+        methods.emplace_back(method);
+    for (const auto *method : record.methods)
+      if (!method->isInstanceMethod)
+        methods.emplace_back(method);
+    writeNumber(methods.size());
+    for (const auto *method : methods) {
+      uint64_t methodBits = 0;
+      if (method->isInstanceMethod)
+        methodBits |= IsInstanceMethod;
+      if (method->isOptional)
+        methodBits |= IsOptional;
+      if (method->isDynamic)
+        methodBits |= IsDynamic;
+      writeRecord(*method, methodBits);
+    }
+
+    writeNumber(record.properties.size());
+    for (const auto *property : record.properties) {
+      writeRecord(*property, property->isOptional ? IsOptional : 0);
+      writeNumber(property->attributes &
+                  (ObjCPropertyRecord::ReadOnly | ObjCPropertyRecord::Dynamic |
+                   ObjCPropertyRecord::Class));
+      writeString(property->getterName);
+      if (!property->isReadOnly())
+        writeString(property->setterName);
+    }
+
+    writeNumber(record.ivars.size());
+    for (const auto *ivar : record.ivars) {
+      writeRecord(*ivar);
+      writeNumber(static_cast<uint64_t>(ivar->accessControl));
+    }
+  }
+
+  void writeBinaryInfo(const BinaryInfo &info) {
+    BinaryFileType fileType;
+    switch (info.fileType) {
+    case FileType::MachO_DynamicLibrary:
+      fileType = BinaryFileType::DynamicLibrary;
+      break;
+    case FileType::MachO_DynamicLibrary_Stub:
+      fileType = BinaryFileType::DynamicLibraryStub;
+      break;
+    case FileType::MachO_Bundle:
+      fileType = BinaryFileType::Bundle;
+      break;
+    default:
+      // All other file types are invalid.
+      fileType = BinaryFileType::Invalid;
+      break;
+    }
+
+    uint64_t bits = 0;
+    if (info.isTwoLevelNamespace)
+      bits |= IsTwoLevelNamespace;
+    if (info.isAppExtensionSafe)
+      bits |= IsAppExtensionSafe;
+
+    writeNumber(static_cast<uint64_t>(fileType));
+    writeNumber(info.currentVersion.rawValue());
+    writeNumber(info.compatibilityVersion.rawValue());
+    writeString(info.installName);
+    writeString(info.parentUmbrella);
+    writeNumber(bits);
+    writeStrings(info.allowableClients);
+    writeStrings(info.reexportedLibraries);
+  }
+
+  void writeAPI(const API &api) {
+    BinaryRecordCollector records;
+    api.visit(records);
+
+    writeString(api.getTriple().str());
+    writeString(api.getProjectName());
+
+    // Records are written in the order the JSON parser adds them, so
+    // categories find their interface when they are read back.
+    writeNumber(records.globals.size());
+    for (const auto *global : records.globals) {
+      writeRecord(*global);
+      writeNumber(static_cast<uint64_t>(global->kind));
+    }
+
+    writeNumber(records.protocols.size());
+    for (const auto *protocol : records.protocols) {
+      writeRecord(*protocol);
+      writeContainerMembers(*protocol);
+    }
+
+    writeNumber(records.interfaces.size());
+    for (const auto *interface : records.interfaces) {
+      writeRecord(*interface,
+                  interface->hasExceptionAttribute() ? HasException : 0);
+      writeString(interface->superClass);
+      writeContainerMembers(*interface);
+    }
+
+    writeNumber(records.categories.size());
+    for (const auto *category : records.categories) {
+      writeRecord(*category);
+      writeString(category->interface);
+      writeContainerMembers(*category);
+    }
+
+    writeNumber(records.enums.size());
+    for (const auto *record : records.enums) {
+      writeRecord(*record);
+      writeNumber(record->constants.size());
+      for (const auto *constant : record->constants)
+        writeRecord(*constant);
+    }
+
+    writeNumber(records.typedefs.size());
+    for (const auto *type : records.typedefs)
+      writeRecord(*type);
+
+    std::vector<StringRef> selectors;
+    for (const auto &s : api.getPotentiallyDefinedSelectors())
+      selectors.emplace_back(s.first());
+    // sort the selectors for reproducibility.
+    llvm::sort(selectors);
+    writeStrings(selectors);
+
+    writeNumber(api.hasBinaryInfo());
+    if (api.hasBinaryInfo())
+      writeBinaryInfo(api.getBinaryInfo());
+  }
+
+  raw_ostream &os;
+  StringMap<uint64_t> strings;
+};
+
+class BinaryPartialSDKDBReader {
+public:
+  BinaryPartialSDKDBReader(StringRef buffer)
+      : data(buffer, /*IsLittleEndian=*/true, /*AddressSize=*/8),
+        cursor(binaryMagic.size()) {}
+
+  // Decode the stream once into the requested outputs. Every API of the
+  // public roots is added to both outputs, SDKContentRoot only to the private
+  // one.
+  Error read(PartialSDKDB *publicOutput, PartialSDKDB *privateOutput) {
+    if (!PartialSDKDB::isBinaryFormat(data.getData()))
+      return createError("invalid binary partial SDKDB signature");
+    auto version = readNumber();
+    if (auto err = checkError())
+      return err;
+    if (version != binaryVersion)
+      return createError("unsupported binary partial SDKDB version");
+
+    auto flags = readNumber();
+    auto project = readString();
+
+    SmallVector<PartialSDKDB *, 2> outputs;
+    if (publicOutput)
+      outputs.emplace_back(publicOutput);
+    if (privateOutput)
+      outputs.emplace_back(privateOutput);
+
+    SmallVector<std::vector<API> *, 2> binaryRoots, headerRoots;
+    for (auto *output : outputs) {
+      binaryRoots.emplace_back(&output->binaryInterfaces);
+      headerRoots.emplace_back(&output->headerInterfaces);
+    }
+
+    if (auto err = readRoot(binaryRoots))
+      return err;
+    if (auto err = readRoot(headerRoots))
+      return err;
+    if (privateOutput) {
+      if (auto err = readRoot(&privateOutput->headerInterfaces))
+        return err;
+    }
+
+    for (auto *output : outputs) {
+      if (!project.empty()) {
+        output->project = project.str();
+        overwriteProjectNames(*output, project);
+      }
+
+      if (flags & HasErrors)
+        output->hasError = true;
+    }
+
+    return Error::success();
+  }
+
+private:
+  bool ok() { return cursor && !malformed; }
+
+  Error createError(const Twine &message) {
+    return make_error<StringError>(message, inconvertibleErrorCode());
+  }
+
+  Error checkError() {
+    if (auto err = cursor.takeError())
+      return err;
+    if (malformed)
+      return createError("malformed binary partial SDKDB");
+    return Error::success();
+  }
+
+  uint64_t readNumber() { return data.getULEB128(cursor); }
+
+  template <typename T> T readEnum(T max) {
+    auto value = readNumber();
+    if (value > static_cast<uint64_t>(max)) {
+      malformed = true;
+      return T();
+    }
+    return static_cast<T>(value);
+  }
+
+  StringRef readString() {
+    auto ref = readNumber();
+    if (ref == 0) {
+      auto size = readNumber();
+      auto str = data.getBytes(cursor, size);
+      strings.emplace_back(str);
+      return str;
+    }
+    if (ref > strings.size()) {
+      malformed = true;
+      return StringRef();
+    }
+    return strings[ref - 1];
+  }
+
+  struct Record {
+    StringRef name;
+    uint64_t bits;
+    APILoc loc;
+    AvailabilityInfo availability;
+    APILinkage linkage;
+    APIAccess access;
+
+    SymbolFlags getFlags() const {
+      auto flags = SymbolFlags::None;
+      if (bits & IsWeakDefined)
+        flags |= SymbolFlags::WeakDefined;
+      if (bits & IsWeakReferenced)
+        flags |= SymbolFlags::WeakReferenced;
+      if (bits & IsThreadLocalValue)
+        flags |= SymbolFlags::ThreadLocalValue;
+      return flags;
+    }
+  };
+
+  Record readRecord() {
+    Record record;
+    record.name = readString();
+    record.bits = readNumber();
+    if (record.bits & HasLocation)
+      record.loc = APILoc(readString().str(), 0, 0);
+    PackedVersion introduced, obsoleted;
+    if (record.bits & HasIntroduced)
+      introduced = PackedVersion(readNumber());
+    if (record.bits & HasObsoleted)
+      obsoleted = PackedVersion(readNumber());
+    if (record.bits &
+        (HasIntroduced | HasObsoleted | IsUnavailable | IsSPIAvailable))
+      record.availability =
+          AvailabilityInfo(introduced, PackedVersion(), obsoleted,
+                           record.bits & IsUnavailable, /*ud=*/false,
+                           record.bits & IsSPIAvailable);
+    record.linkage = readEnum(APILinkage::Exported);
+    record.access = readEnum(APIAccess::Public);
+    return record;
+  }
+
+  // The containers are the same record added to each of the APIs.
+  void readContainerMembers(ArrayRef<API *> apis,
+                            ArrayRef<ObjCContainerRecord *> containers) {
+    auto numProtocols = readNumber();
+    for (uint64_t i = 0; i < numProtocols && ok(); ++i) {
+      auto protocol = readString();
+      for (size_t j = 0; j < apis.size(); ++j)
+        containers[j]->protocols.emplace_back(apis[j]->copyString(protocol));
+    }
+
+    auto numMethods = readNumber();
+    for (uint64_t i = 0; i < numMethods && ok(); ++i) {
+      auto method = readRecord();
+      for (size_t j = 0; j < apis.size(); ++j)
+        apis[j]->addObjCMethod(containers[j], method.name, method.loc,
+                               method.availability, method.access,
+                               method.bits & IsInstanceMethod,
+                               method.bits & IsOptional,
+                               method.bits & IsDynamic, /*Decl*/ nullptr);
+    }
+
+    auto numProperties = readNumber();
+    for (uint64_t i = 0; i < numProperties && ok(); ++i) {
+      auto property = readRecord();
+      auto attributes = readEnum(static_cast<ObjCPropertyRecord::AttributeKind>(
+          ObjCPropertyRecord::ReadOnly | ObjCPropertyRecord::Dynamic |
+          ObjCPropertyRecord::Class));
+      auto getter = readString();
+      StringRef setter;
+      if (!(attributes & ObjCPropertyRecord::ReadOnly))
+        setter = readString();
+      for (size_t j = 0; j < apis.size(); ++j)
+        apis[j]->addObjCProperty(containers[j], property.name, getter, setter,
+                                 property.loc, property.availability,
+                                 property.access, attributes,
+                                 property.bits & IsOptional, /*Decl*/ nullptr);
+    }
+
+    auto numIvars = readNumber();
+    for (uint64_t i = 0; i < numIvars && ok(); ++i) {
+      auto ivar = readRecord();
+      auto accessControl =
+          readEnum(ObjCInstanceVariableRecord::AccessControl::Package);
+      for (size_t j = 0; j < apis.size(); ++j)
+        apis[j]->addObjCInstanceVariable(containers[j], ivar.name, ivar.loc,
+                                         ivar.availability, ivar.access,
+                                         accessControl, ivar.linkage,
+                                         /*Decl*/ nullptr);
+    }
+  }
+
+  void readBinaryInfo(ArrayRef<API *> apis) {
+    auto fileType = FileType::Invalid;
+    switch (readEnum(BinaryFileType::Bundle)) {
+    case BinaryFileType::Invalid:
+      break;
+    case BinaryFileType::DynamicLibrary:
+      fileType = FileType::MachO_DynamicLibrary;
+      break;
+    case BinaryFileType::DynamicLibraryStub:
+      fileType = FileType::MachO_DynamicLibrary_Stub;
+      break;
+    case BinaryFileType::Bundle:
+      fileType = FileType::MachO_Bundle;
+      break;
+    }
+    auto currentVersion = PackedVersion(readNumber());
+    auto compatibilityVersion = PackedVersion(readNumber());
+    auto installName = readString();
+    auto parentUmbrella = readString();
+    auto bits = readNumber();
+
+    std::vector<StringRef> clients;
+    auto numClients = readNumber();
+    for (uint64_t i = 0; i < numClients && ok(); ++i)
+      clients.emplace_back(readString());
+    std::vector<StringRef> libraries;
+    auto numLibraries = readNumber();
+    for (uint64_t i = 0; i < numLibraries && ok(); ++i)
+      libraries.emplace_back(readString());
+
+    for (auto *api : apis) {
+      auto &info = api->getBinaryInfo();
+      info.fileType = fileType;
+      info.currentVersion = currentVersion;
+      info.compatibilityVersion = compatibilityVersion;
+      info.installName = api->copyString(installName);
+      if (!parentUmbrella.empty())
+        info.parentUmbrella = api->copyString(parentUmbrella);
+      info.isTwoLevelNamespace = bits & IsTwoLevelNamespace;
+      info.isAppExtensionSafe = bits & IsAppExtensionSafe;
+      for (auto client : clients)
+        info.allowableClients.emplace_back(api->copyString(client));
+      for (auto library : libraries)
+        info.reexportedLibraries.emplace_back(api->copyString(library));
+    }
+  }
+
+  // Decode one API and add each of its records to every API in apis.
+  void readAPI(ArrayRef<API *> apis) {
+    SmallVector<ObjCContainerRecord *, 2> containers;
+    auto numGlobals = readNumber();
+    for (uint64_t i = 0; i < numGlobals && ok(); ++i) {
+      auto global = readRecord();
+      auto kind = readEnum(GVKind::Function);
+      for (auto *api : apis)
+        api->addGlobal(global.name, global.getFlags(), global.loc,
+                       global.availability, global.access, /*Decl*/ nullptr,
+                       kind, global.linkage);
+    }
+
+    auto numProtocols = readNumber();
+    for (uint64_t i = 0; i < numProtocols && ok(); ++i) {
+      auto protocol = readRecord();
+      containers.clear();
+      for (auto *api : apis)
+        containers.emplace_back(api->addObjCProtocol(
+            protocol.name, protocol.loc, protocol.availability,
+            protocol.access, /*Decl*/ nullptr));
+      readContainerMembers(apis, containers);
+    }
+
+    auto numInterfaces = readNumber();
+    for (uint64_t i = 0; i < numInterfaces && ok(); ++i) {
+      auto interface = readRecord();
+      ObjCIFSymbolKind symType =
+          ObjCIFSymbolKind::Class | ObjCIFSymbolKind::MetaClass;
+      if (interface.bits & HasException)
+        symType |= ObjCIFSymbolKind::EHType;
+      auto superClass = readString();
+      containers.clear();
+      for (auto *api : apis)
+        containers.emplace_back(api->addObjCInterface(
+            interface.name, interface.loc, interface.availability,
+            interface.access, interface.linkage, superClass,
+            /*Decl*/ nullptr, symType));
+      readContainerMembers(apis, containers);
+    }
+
+    auto numCategories = readNumber();
+    for (uint64_t i = 0; i < numCategories && ok(); ++i) {
+      auto category = readRecord();
+      auto interface = readString();
+      containers.clear();
+      for (auto *api : apis)
+        containers.emplace_back(api->addObjCCategory(
+            interface, category.name, category.loc, category.availability,
+            category.access, /*Decl*/ nullptr));
+      readContainerMembers(apis, containers);
+    }
+
+    auto numEnums = readNumber();
+    for (uint64_t i = 0; i < numEnums && ok(); ++i) {
+      auto enumRecord = readRecord();
+      // The USR is not part of the partial SDKDB.
+      SmallVector<EnumRecord *, 2> records;
+      for (auto *api : apis)
+        records.emplace_back(api->addEnum(enumRecord.name, /*usr=*/"",
+                                          enumRecord.loc,
+                                          enumRecord.availability,
+                                          enumRecord.access,
+                                          /*Decl*/ nullptr));
+      auto numConstants = readNumber();
+      for (uint64_t j = 0; j < numConstants && ok(); ++j) {
+        auto constant = readRecord();
+        for (size_t k = 0; k < apis.size(); ++k)
+          apis[k]->addEnumConstant(records[k], constant.name, constant.loc,
+                                   constant.availability, constant.access,
+                                   /*Decl*/ nullptr);
+      }
+    }
+
+    auto numTypedefs = readNumber();
+    for (uint64_t i = 0; i < numTypedefs && ok(); ++i) {
+      auto type = readRecord();
+      for (auto *api : apis)
+        api->addTypeDef(type.name, type.loc, type.availability, type.access,
+                        /*Decl*/ nullptr);
+    }
+
+    auto numSelectors = readNumber();
+    for (uint64_t i = 0; i < numSelectors && ok(); ++i) {
+      auto selector = readString();
+      for (auto *api : apis)
+        api->addPotentiallyDefinedSelector(selector);
+    }
+
+    if (readNumber())
+      readBinaryInfo(apis);
+  }
+
+  // Read a root and append each of its APIs to every vector in roots.
+  Error readRoot(ArrayRef<std::vector<API> *> roots) {
+    auto numAPIs = readNumber();
+    for (uint64_t i = 0; i < numAPIs && ok(); ++i) {
+      auto triple = readString();
+      auto project = readString();
+      SmallVector<API *, 2> apis;
+      for (auto *root : roots) {
+        root->emplace_back(Triple(triple));
+        if (!project.empty())
+          root->back().setProjectName(project);
+        apis.emplace_back(&root->back());
+      }
+      readAPI(apis);
+    }
+    return checkError();
+  }
+
+  DataExtractor data;
+  DataExtractor::Cursor cursor;
+  std::vector<StringRef> strings;
+  bool malformed = false;
+};
+
+} // end anonymous namespace
+
+bool PartialSDKDB::isBinaryFormat(StringRef buffer) {
+  return buffer.startswith(binaryMagic);
+}
+
+Expected<PartialSDKDB>
+PartialSDKDB::createPublicAPIsFromBinary(StringRef buffer) {
+  PartialSDKDB output;
+  if (auto err = createAPIsFromBinary(buffer, &output, nullptr))
+    return std::move(err);
+  return std::move(output);
+}
+
+Expected<PartialSDKDB>
+PartialSDKDB::createPrivateAPIsFromBinary(StringRef buffer) {
+  PartialSDKDB output;
+  if (auto err = createAPIsFromBinary(buffer, nullptr, &output))
+    return std::move(err);
+  return std::move(output);
+}
+
+Error PartialSDKDB::createAPIsFromBinary(StringRef buffer,
+                                         PartialSDKDB *publicOutput,
+                                         PartialSDKDB *privateOutput) {
+  BinaryPartialSDKDBReader reader(buffer);
+  return reader.read(publicOutput, privateOutput);
+}
+
+Error PartialSDKDB::serializeBinary(
+    llvm::raw_ostream &os, StringRef project,
+    const std::vector<API> &binaryInterfaces,
+    const std::vector<FrontendContext> &publicHeaderContext,
+    const std::vector<API> &publicHeaderAPIs,
+    const std::vector<FrontendContext> &privateHeaderContext,
+    const std::vector<API> &privateHeaderAPIs, bool hasErrors) {
+  auto collect = [](const std::vector<FrontendContext> &contexts,
+                    const std::vector<API> &apis) {
+    std::vector<const API *> result;
+    for (const auto &context : contexts)
+      result.emplace_back(context.api.get());
+    for (const auto &api : apis)
+      result.emplace_back(&api);
+    return result;
+  };
+
+  BinaryPartialSDKDBWriter writer(os);
+  writer.writeHeader(project, hasErrors);
+  // RuntimeRoot.
+  writer.writeRoot(collect({}, binaryInterfaces));
+  // PublicSDKContentRoot.
+  writer.writeRoot(collect(publicHeaderContext, publicHeaderAPIs));
+  // SDKContentRoot.
+  writer.writeRoot(collect(privateHeaderContext, privateHeaderAPIs));
+
+  return Error::success();
+}
+
 TAPI_NAMESPACE_INTERNAL_END
@@ -18,8 +18,15 @@
 #include "tapi/Core/APIVisitor.h"
 #include "tapi/Core/Utils.h"
 #include "tapi/Diagnostics/Diagnostics.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/xxhash.h"
+#include <functional>
+#include <map>
+#include <variant>
 #include <vector>
 
 using namespace llvm;
@@ -126,19 +133,35 @@ API &SDKDB::recordAPI(API &&api) {
       builder->report(diag::warn_sdkdb_conflict_install_name)
           << installName.value() << it->getValue() << api.getProjectName();
 
-    for (const auto reexport : api.getBinaryInfo().reexportedLibraries)
+    for (const auto reexport : api.getBinaryInfo().reexportedLibraries) {
       reexportGraph[reexport].emplace_back(*installName);
+      hasReexportClosure = false;
+    }
   }
 
   return apiCache[name].back();
 }
 
+void SDKDB::setContentHash(StringRef installName, uint64_t hash) {
+  auto [it, inserted] = contentHashes.try_emplace(installName, hash);
+  if (!inserted)
+    it->second = llvm::hash_combine(it->second, hash);
+}
+
+std::optional<uint64_t> SDKDB::getContentHash(StringRef installName) const {
+  auto it = contentHashes.find(installName);
+  if (it == contentHashes.end())
+    return std::nullopt;
+  return it->second;
+}
+
 void SDKDB::insertGlobal(GlobalRecord *record, const BinaryInfo *binInfo,
                          StringRef project) {
   // only insert exported and re-exported symbols into map.
   if (record->linkage < APILinkage::Reexported)
     return;
 
+  project = internProjectName(project);
   auto key = record->name;
   auto &value = globalMap[key];
 
@@ -162,6 +185,7 @@ void SDKDB::insertGlobal(GlobalRecord *record, const BinaryInfo *binInfo,
 
 void SDKDB::insertObjCInterface(ObjCInterfaceRecord *record,
                                 const BinaryInfo *binInfo, StringRef project) {
+  project = internProjectName(project);
   auto key = record->name;
   auto result = interfaceMap.try_emplace(key, record, binInfo, project);
   // If emplace successful.
@@ -187,6 +211,7 @@ void SDKDB::insertObjCInterface(ObjCInterfaceRecord *record,
 
 void SDKDB::insertObjCCategory(ObjCCategoryRecord *record,
                                const BinaryInfo *binInfo, StringRef project) {
+  project = internProjectName(project);
   auto &catMap = categoryMap[record->interface];
   auto result = catMap.try_emplace(record->name, record, binInfo, project);
   // If emplace successful.
@@ -247,6 +272,7 @@ ObjCProtocolRecord *SDKDB::addObjCProtocol(const ObjCProtocolRecord &record) {
 
 void SDKDB::insertEnum(EnumRecord *record, const BinaryInfo *binInfo,
                        StringRef project) {
+  project = internProjectName(project);
   auto key = record->name;
   auto result = enumMap.try_emplace(key, record, binInfo, project);
   // If emplace successful.
@@ -269,6 +295,7 @@ void SDKDB::insertEnum(EnumRecord *record, const BinaryInfo *binInfo,
 
 void SDKDB::insertTypeDef(TypedefRecord *record, const BinaryInfo *binInfo,
                           StringRef project) {
+  project = internProjectName(project);
   auto key = record->name;
   auto result = typedefMap.try_emplace(key, record, binInfo, project);
   // If emplace successful.
@@ -393,6 +420,7 @@ static ObjCPropertyRecord *findProperty(StringRef name,
 
 void SDKDB::insertObjCProtocol(ObjCProtocolRecord *record,
                                const BinaryInfo *binInfo, StringRef project) {
+  project = internProjectName(project);
   auto key = record->name;
   auto result = protocolMap.try_emplace(key, record, binInfo, project);
   if (result.second)
@@ -616,7 +644,22 @@ Error SDKDB::finalize() {
   // Finalize SDKDB.
   // Update the access of methods and properties to public if there exists super
   // class/protocol which declares the method/property to be public.
+  //
+  // Computing the new access only reads the lookup maps, so it runs
+  // concurrently for all the containers of one kind, and the results are
+  // applied afterwards. A container only gains access from the containers it
+  // walks, and those are walked again here, so it doesn't matter if a container
+  // sees the updated or the original access of another one. The result is the
+  // same as updating the containers one by one.
+  using AccessUpdates = SmallVector<std::pair<APIRecord *, APIAccess>, 4>;
+  auto applyAccessUpdates = [](ArrayRef<AccessUpdates> updates) {
+    for (const auto &list : updates)
+      for (const auto &update : list)
+        update.first->access = update.second;
+  };
+
   // 1. Update Protocol methods and properties.
+  std::vector<ObjCProtocolRecord *> protocols;
   for (auto &entry : protocolMap) {
     auto *protocol = entry.getValue().getRecord();
     if (entry.getValue().isPoison()) {
@@ -629,23 +672,35 @@ Error SDKDB::finalize() {
     if (protocol->access != APIAccess::Public)
       continue;
 
-    for (auto *method : protocol->methods) {
-      if (method->access != APIAccess::Public &&
-          builder->isMaybePublicSelector(method->name))
-        method->access = getAccessForObjCMethod(
-            method->access, method->name, method->isInstanceMethod, protocol);
-    }
-
-    for (auto *property : protocol->properties) {
-      if (property->access != APIAccess::Public &&
-          builder->isMaybePublicProperty(property->name))
-        property->access =
-            getAccessForObjCProperty(property->access, property->name,
-                                     property->isClassProperty(), protocol);
-    }
+    protocols.emplace_back(protocol);
   }
 
+  std::vector<AccessUpdates> protocolUpdates(protocols.size());
+  parallelForEachIndex(
+      protocols.size(), builder->getNumThreads(), [&](size_t i) {
+        auto *protocol = protocols[i];
+        for (auto *method : protocol->methods) {
+          if (method->access != APIAccess::Public &&
+              builder->isMaybePublicSelector(method->name))
+            protocolUpdates[i].emplace_back(
+                method,
+                getAccessForObjCMethod(method->access, method->name,
+                                       method->isInstanceMethod, protocol));
+        }
+
+        for (auto *property : protocol->properties) {
+          if (property->access != APIAccess::Public &&
+              builder->isMaybePublicProperty(property->name))
+            protocolUpdates[i].emplace_back(
+                property, getAccessForObjCProperty(
+                              property->access, property->name,
+                              property->isClassProperty(), protocol));
+        }
+      });
+  applyAccessUpdates(protocolUpdates);
+
   // 2. Update Interface methods and properties.
+  std::vector<ObjCInterfaceRecord *> interfaces;
   for (auto &entry : interfaceMap) {
     auto *interface = entry.getValue().getRecord();
     if (entry.getValue().isPoison()) {
@@ -658,27 +713,39 @@ Error SDKDB::finalize() {
     if (interface->access != APIAccess::Public)
       continue;
 
-    for (auto *method : interface->methods) {
-      if (method->access != APIAccess::Public &&
-          builder->isMaybePublicSelector(method->name))
-        method->access = getAccessForObjCMethod(
-            method->access, method->name, method->isInstanceMethod, interface);
-    }
-
-    for (auto *property : interface->properties) {
-      if (property->access != APIAccess::Public &&
-          builder->isMaybePublicProperty(property->name))
-        property->access =
-            getAccessForObjCProperty(property->access, property->name,
-                                     property->isClassProperty(), interface);
-    }
+    interfaces.emplace_back(interface);
   }
 
+  std::vector<AccessUpdates> interfaceUpdates(interfaces.size());
+  parallelForEachIndex(
+      interfaces.size(), builder->getNumThreads(), [&](size_t i) {
+        auto *interface = interfaces[i];
+        for (auto *method : interface->methods) {
+          if (method->access != APIAccess::Public &&
+              builder->isMaybePublicSelector(method->name))
+            interfaceUpdates[i].emplace_back(
+                method,
+                getAccessForObjCMethod(method->access, method->name,
+                                       method->isInstanceMethod, interface));
+        }
+
+        for (auto *property : interface->properties) {
+          if (property->access != APIAccess::Public &&
+              builder->isMaybePublicProperty(property->name))
+            interfaceUpdates[i].emplace_back(
+                property, getAccessForObjCProperty(
+                              property->access, property->name,
+                              property->isClassProperty(), interface));
+        }
+      });
+  applyAccessUpdates(interfaceUpdates);
+
   // 3. Update Category methods and properties.
+  std::vector<std::pair<ObjCCategoryRecord *, ObjCInterfaceRecord *>>
+      categories;
   for (auto &catEntry : categoryMap) {
-    auto categories = catEntry.getValue();
     ObjCInterfaceRecord *interface = findObjCInterface(catEntry.getKey());
-    for (auto &entry : categories) {
+    for (auto &entry : catEntry.getValue()) {
       auto *category = entry.getValue().getRecord();
       if (entry.getValue().isPoison()) {
         std::string diagName =
@@ -692,35 +759,46 @@ Error SDKDB::finalize() {
       if (category->access != APIAccess::Public)
         continue;
 
-      for (auto *method : category->methods) {
-        if (method->access != APIAccess::Public &&
-          builder->isMaybePublicSelector(method->name)) {
-          method->access =
-              getAccessForObjCMethod(method->access, method->name,
-                                     method->isInstanceMethod, category);
-          // Look at base class if exists.
-          if (method->access != APIAccess::Public && interface)
-            method->access =
+      categories.emplace_back(category, interface);
+    }
+  }
+
+  std::vector<AccessUpdates> categoryUpdates(categories.size());
+  parallelForEachIndex(
+      categories.size(), builder->getNumThreads(), [&](size_t i) {
+        auto *category = categories[i].first;
+        auto *interface = categories[i].second;
+        for (auto *method : category->methods) {
+          if (method->access != APIAccess::Public &&
+              builder->isMaybePublicSelector(method->name)) {
+            auto access =
                 getAccessForObjCMethod(method->access, method->name,
-                                       method->isInstanceMethod, interface);
+                                       method->isInstanceMethod, category);
+            // Look at base class if exists.
+            if (access != APIAccess::Public && interface)
+              access = getAccessForObjCMethod(access, method->name,
+                                              method->isInstanceMethod,
+                                              interface);
+            categoryUpdates[i].emplace_back(method, access);
+          }
         }
-      }
 
-      for (auto *property : category->properties) {
-        if (property->access != APIAccess::Public &&
-            builder->isMaybePublicProperty(property->name)) {
-          property->access =
-              getAccessForObjCProperty(property->access, property->name,
-                                       property->isClassProperty(), category);
-          // Look at base class if exists.
-          if (property->access != APIAccess::Public && interface)
-            property->access = getAccessForObjCProperty(
+        for (auto *property : category->properties) {
+          if (property->access != APIAccess::Public &&
+              builder->isMaybePublicProperty(property->name)) {
+            auto access = getAccessForObjCProperty(
                 property->access, property->name, property->isClassProperty(),
-                interface);
+                category);
+            // Look at base class if exists.
+            if (access != APIAccess::Public && interface)
+              access = getAccessForObjCProperty(access, property->name,
+                                                property->isClassProperty(),
+                                                interface);
+            categoryUpdates[i].emplace_back(property, access);
+          }
         }
-      }
-    }
-  }
+      });
+  applyAccessUpdates(categoryUpdates);
 
   // Perform SDKDB finalize.
   // 1. Fixup all the protocols in the SDKDB.
@@ -1119,38 +1197,198 @@ Error SDKDBBuilder::finalize() {
   return Error::success();
 }
 
-llvm::Error SDKDBBuilder::parse(StringRef JSON) {
-  auto inputValue = json::parse(JSON);
-  if (!inputValue)
-    return inputValue.takeError();
+namespace {
 
-  auto *root = inputValue->getAsObject();
-  if (!root)
-    return make_error<APIJSONError>("SDKDB is not a JSON Object");
+/// Scans the top level structure of an SDKDB JSON file and hands out the text
+/// of each value, so only a single API needs to be parsed into a JSON object
+/// at any time. The values themselves are validated by json::parse.
+class SDKDBJSONScanner {
+public:
+  SDKDBJSONScanner(StringRef input) : input(input) {}
 
-  for (auto &target : *root) {
-    const StringRef key = target.first;
-    if (key == "public")
-      continue;
-    auto triple = Triple(key);
-    auto payload = target.second.getAsArray();
-    if (!payload)
-      return make_error<APIJSONError>("Target Payload is not a JSON Array");
-
-    for (auto &value : *payload) {
-      auto obj = value.getAsObject();
-      if (!obj)
-        return make_error<APIJSONError>(
-            "SDKDB doesn't include correct API format");
-      auto api = APIJSONSerializer::parse(obj, isPublicOnly(), &triple);
-      if (!api)
-        return api.takeError();
-
-      if (auto err = addBinaryAPI(std::move(*api)))
-        return err;
+  bool consume(char c) {
+    skipWhitespace();
+    if (pos == input.size() || input[pos] != c)
+      return false;
+    ++pos;
+    return true;
+  }
+
+  bool atEnd() {
+    skipWhitespace();
+    return pos == input.size();
+  }
+
+  Expected<std::string> readString() {
+    skipWhitespace();
+    auto start = pos;
+    if (pos == input.size() || input[pos] != '"')
+      return make_error<APIJSONError>("expected string in SDKDB");
+    if (auto err = skipString())
+      return std::move(err);
+
+    auto text = input.slice(start, pos);
+    if (!text.contains('\\'))
+      return text.drop_front().drop_back().str();
+
+    auto value = json::parse(text);
+    if (!value)
+      return value.takeError();
+    return value->getAsString()->str();
+  }
+
+  Expected<StringRef> readValue() {
+    skipWhitespace();
+    auto start = pos;
+    unsigned depth = 0;
+    do {
+      if (pos == input.size())
+        return make_error<APIJSONError>("malformed value in SDKDB");
+
+      char c = input[pos];
+      if (c == '"') {
+        if (auto err = skipString())
+          return std::move(err);
+        continue;
+      }
+
+      if (c == '{' || c == '[') {
+        ++depth;
+      } else if (c == '}' || c == ']') {
+        if (depth == 0)
+          break;
+        --depth;
+      } else if (depth == 0) {
+        // Scalars end at the next separator.
+        while (pos != input.size() && !isSeparator(input[pos]))
+          ++pos;
+        break;
+      }
+      ++pos;
+    } while (depth != 0);
+
+    if (start == pos)
+      return make_error<APIJSONError>("malformed value in SDKDB");
+    return input.slice(start, pos);
+  }
+
+private:
+  void skipWhitespace() {
+    while (pos != input.size() && isSpace(input[pos]))
+      ++pos;
+  }
+
+  Error skipString() {
+    // Skip the opening quote.
+    ++pos;
+    while (pos < input.size()) {
+      char c = input[pos++];
+      if (c == '\\')
+        ++pos;
+      else if (c == '"')
+        return Error::success();
     }
+    return make_error<APIJSONError>("unterminated string in SDKDB");
+  }
+
+  static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  static bool isSeparator(char c) {
+    return c == ',' || c == '}' || c == ']' || isSpace(c);
   }
 
+  StringRef input;
+  size_t pos = 0;
+};
+
+} // end anonymous namespace
+
+llvm::Error SDKDBBuilder::parse(StringRef JSON) {
+  // Parse the APIs one by one, instead of parsing the whole SDKDB into a JSON
+  // object first.
+  SDKDBJSONScanner scanner(JSON);
+  if (!scanner.consume('{'))
+    return make_error<APIJSONError>("SDKDB is not a JSON Object");
+
+  if (!scanner.consume('}')) {
+    do {
+      auto key = scanner.readString();
+      if (!key)
+        return key.takeError();
+
+      if (!scanner.consume(':'))
+        return make_error<APIJSONError>("SDKDB is not a JSON Object");
+
+      if (*key == "public" || *key == "projectWithError") {
+        auto text = scanner.readValue();
+        if (!text)
+          return text.takeError();
+
+        if (*key == "public")
+          continue;
+
+        auto value = json::parse(*text);
+        if (!value)
+          return value.takeError();
+        auto *projects = value->getAsArray();
+        if (!projects)
+          return make_error<APIJSONError>(
+              "projectWithError is not a JSON Array");
+        for (auto &project : *projects) {
+          if (auto name = project.getAsString())
+            addProjectWithError(*name);
+        }
+        continue;
+      }
+
+      auto triple = Triple(*key);
+      if (!scanner.consume('['))
+        return make_error<APIJSONError>("Target Payload is not a JSON Array");
+
+      if (scanner.consume(']'))
+        continue;
+
+      do {
+        auto text = scanner.readValue();
+        if (!text)
+          return text.takeError();
+
+        auto value = json::parse(*text);
+        if (!value)
+          return value.takeError();
+
+        auto *obj = value->getAsObject();
+        if (!obj)
+          return make_error<APIJSONError>(
+              "SDKDB doesn't include correct API format");
+        auto api = APIJSONSerializer::parse(obj, isPublicOnly(), &triple);
+        if (!api)
+          return api.takeError();
+
+        uint64_t contentHash;
+        auto hash = obj->getString("contentHash");
+        if (hash && !hash->getAsInteger(16, contentHash) &&
+            api->hasBinaryInfo())
+          getSDKDBForTarget(api->getTriple())
+              .setContentHash(api->getBinaryInfo().installName, contentHash);
+
+        if (auto err = addBinaryAPI(std::move(*api)))
+          return err;
+      } while (scanner.consume(','));
+
+      if (!scanner.consume(']'))
+        return make_error<APIJSONError>("Target Payload is not a JSON Array");
+    } while (scanner.consume(','));
+
+    if (!scanner.consume('}'))
+      return make_error<APIJSONError>("SDKDB is not a JSON Object");
+  }
+
+  if (!scanner.atEnd())
+    return make_error<APIJSONError>("unexpected text after SDKDB");
+
   return Error::success();
 }
 
@@ -1173,48 +1411,159 @@ std::vector<const SDKDB*> SDKDBBuilder::getDatabases() const {
   return sortedDatabases;
 }
 
-void SDKDBBuilder::serialize(raw_ostream &os, bool compact) const {
-  json::Object root;
-  APIJSONOption serializeOpts = {
+static APIJSONOption getSerializeOption(const SDKDBBuilder &builder,
+                                        bool compact) {
+  return {
       compact,
-      !hasUUID(),
+      !builder.hasUUID(),
       /*no target*/ true,
       /*external only*/ true,
-      isPublicOnly(),
+      builder.isPublicOnly(),
       /*ignore line and col*/ true,
   };
-  for (auto *entry : getDatabases()) {
-    auto target = entry->getTargetTriple();
-    json::Array apiList;
-    for (auto *api : entry->api()) {
-      if (api->isEmpty())
+}
+
+namespace {
+
+// Forwards everything to the output stream and, while capturing, also keeps
+// the compact form of the JSON object that is being written. Pretty printing
+// only adds whitespace outside of strings, so dropping that whitespace gives
+// the same bytes the compact serializer writes, and the content hash can be
+// taken from the SDKDB output instead of serializing the API a second time.
+class ContentHashStream : public raw_ostream {
+public:
+  ContentHashStream(raw_ostream &os) : os(os) { SetUnbuffered(); }
+
+  // Start capturing the next JSON object. The separator written before the
+  // object is skipped.
+  void startCapture(StringRef prefix) {
+    captured.assign(prefix);
+    capturing = true;
+    inObject = false;
+    inString = false;
+    isEscaped = false;
+  }
+
+  // Stop capturing and hash the object written so far as if it ended here.
+  uint64_t finishCapture() {
+    capturing = false;
+    captured.push_back('}');
+    return xxHash64(captured);
+  }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    os.write(ptr, size);
+    pos += size;
+    if (!capturing)
+      return;
+
+    for (char c : StringRef(ptr, size)) {
+      if (!inObject) {
+        if (c != '{')
+          continue;
+        inObject = true;
+      } else if (inString) {
+        if (isEscaped)
+          isEscaped = false;
+        else if (c == '\\')
+          isEscaped = true;
+        else if (c == '"')
+          inString = false;
+      } else if (c == '"') {
+        inString = true;
+      } else if (isSpace(c)) {
         continue;
-      APIJSONSerializer serializer(*api, serializeOpts);
-      apiList.emplace_back(serializer.getJSONObject());
+      }
+      captured.push_back(c);
     }
-    root[target.str()] = std::move(apiList);
   }
-  if (isPublicOnly())
-    root["public"] = true;
 
-  json::Array projects;
-  for (auto &proj : projectWithError)
-    projects.push_back(proj);
-  if (!projects.empty())
-    root["projectWithError"] = std::move(projects);
+  uint64_t current_pos() const override { return pos; }
+
+  raw_ostream &os;
+  uint64_t pos = 0;
+  SmallString<4096> captured;
+  bool capturing = false;
+  bool inObject = false;
+  bool inString = false;
+  bool isEscaped = false;
+};
+
+} // end anonymous namespace
 
-  if (compact)
-    os << formatv("{0}", json::Value(std::move(root))) << "\n";
-  else
-    os << formatv("{0:2}", json::Value(std::move(root))) << "\n";
+uint64_t SDKDBBuilder::computeContentHash(const API &api) const {
+  // Hash the same bytes the JSON output captures in serialize().
+  SmallString<4096> buffer;
+  raw_svector_ostream os(buffer);
+  os << getRawOptionEncoding() << "\n";
+  json::OStream json(os);
+  APIJSONSerializer serializer(api,
+                               getSerializeOption(*this, /*compact*/ true));
+  serializer.serialize(json);
+  return xxHash64(buffer);
 }
 
+void SDKDBBuilder::serialize(raw_ostream &os, bool compact) const {
+  auto serializeOpts = getSerializeOption(*this, compact);
+
+  // Stream the APIs one at a time instead of building the whole SDKDB as a
+  // JSON object first. The top level keys are written in the sorted order
+  // json::Object uses, so the output doesn't change.
+  std::map<std::string, const SDKDB *> topLevelKeys;
+  for (auto *entry : getDatabases())
+    topLevelKeys.emplace(entry->getTargetTriple().str(), entry);
+  if (isPublicOnly())
+    topLevelKeys.emplace("public", nullptr);
+  if (!projectWithError.empty())
+    topLevelKeys.emplace("projectWithError", nullptr);
+
+  // The content hash of each library is taken from its own output.
+  ContentHashStream hashStream(os);
+  std::string hashPrefix = std::to_string(getRawOptionEncoding()) + "\n";
+  json::OStream json(hashStream, compact ? 0 : 2);
+  json.object([&]() {
+    for (auto &key : topLevelKeys) {
+      if (!key.second) {
+        if (key.first == "public")
+          json.attribute("public", true);
+        else
+          json.attributeArray("projectWithError", [&]() {
+            for (auto &proj : projectWithError)
+              json.value(proj);
+          });
+        continue;
+      }
+
+      json.attributeArray(key.first, [&]() {
+        for (auto *api : key.second->api()) {
+          if (api->isEmpty())
+            continue;
+          APIJSONSerializer serializer(*api, serializeOpts);
+          if (api->hasBinaryInfo() &&
+              !api->getBinaryInfo().installName.empty()) {
+            hashStream.startCapture(hashPrefix);
+            serializer.setContentHash(
+                [&]() { return hashStream.finishCapture(); });
+          }
+          serializer.serialize(json);
+        }
+      });
+    }
+  });
+  os << "\n";
+}
+
+// Sorted and unique keys of both maps.
 template <typename LookupMapTy>
-inline std::set<StringRef> allKeysFromMaps(const LookupMapTy &base,
-                                           const LookupMapTy &test) {
-  std::set<StringRef> keys;
-  keys.insert(base.keys().begin(), base.keys().end());
-  keys.insert(test.keys().begin(), test.keys().end());
+inline std::vector<StringRef> allKeysFromMaps(const LookupMapTy &base,
+                                              const LookupMapTy &test) {
+  std::vector<StringRef> keys;
+  keys.reserve(base.size() + test.size());
+  keys.insert(keys.end(), base.keys().begin(), base.keys().end());
+  keys.insert(keys.end(), test.keys().begin(), test.keys().end());
+  llvm::sort(keys);
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
   return keys;
 }
 
@@ -1240,21 +1589,85 @@ inline std::set<std::pair<StringRef, bool>> allMethods(const MethodsTy &base,
   return methods;
 }
 
+// Sorted and unique key pairs of both nested maps.
 template <typename LookupMapTy>
-inline std::set<std::pair<StringRef, StringRef>>
+inline std::vector<std::pair<StringRef, StringRef>>
 allKeyPairsFromNestedMaps(const LookupMapTy &base, const LookupMapTy &test) {
-  std::set<std::pair<StringRef, StringRef>> keys;
+  std::vector<std::pair<StringRef, StringRef>> keys;
   for (auto &k1 : base) {
     for (auto &k2 : k1.getValue())
-      keys.emplace(k1.getKey(), k2.getKey());
+      keys.emplace_back(k1.getKey(), k2.getKey());
   }
   for (auto &k1 : test) {
     for (auto &k2 : k1.getValue())
-      keys.emplace(k1.getKey(), k2.getKey());
+      keys.emplace_back(k1.getKey(), k2.getKey());
   }
+  llvm::sort(keys);
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
   return keys;
 }
 
+namespace {
+
+/// Records the diagnostics of a compare running on a worker thread, so they
+/// can be reported later in the same order as a serial compare.
+class DiagnosticBuffer {
+  using Argument = std::variant<std::string, int, unsigned>;
+  struct Diagnostic {
+    unsigned diagID;
+    SmallVector<Argument, 6> args;
+  };
+
+public:
+  class Builder {
+  public:
+    Builder(SmallVectorImpl<Argument> &args) : args(args) {}
+
+    Builder &operator<<(StringRef str) {
+      args.emplace_back(str.str());
+      return *this;
+    }
+    Builder &operator<<(const char *str) {
+      args.emplace_back(std::string(str));
+      return *this;
+    }
+    Builder &operator<<(int value) {
+      args.emplace_back(value);
+      return *this;
+    }
+    Builder &operator<<(unsigned value) {
+      args.emplace_back(value);
+      return *this;
+    }
+    // Clang streams booleans as signed integers.
+    Builder &operator<<(bool value) {
+      args.emplace_back((int)value);
+      return *this;
+    }
+
+  private:
+    SmallVectorImpl<Argument> &args;
+  };
+
+  Builder report(unsigned diagID) {
+    diagnostics.push_back({diagID, {}});
+    return Builder(diagnostics.back().args);
+  }
+
+  void replay(SDKDBBuilder &builder) const {
+    for (const auto &diagnostic : diagnostics) {
+      auto diag = builder.report(diagnostic.diagID);
+      for (const auto &arg : diagnostic.args)
+        std::visit([&](const auto &value) { diag << value; }, arg);
+    }
+  }
+
+private:
+  std::vector<Diagnostic> diagnostics;
+};
+
+} // end anonymous namespace
+
 static bool checkAPIRecord(const APIRecord &record, const APIRecord &base,
                            std::function<void(StringRef)> handler) {
   assert(record.name == base.name && "record names are not equal");
@@ -1337,22 +1750,69 @@ static bool checkObjCContainer(
 void SDKDB::buildLookupTables() {
   assert(globalMap.empty() && interfaceMap.empty() && categoryMap.empty() &&
          protocolMap.empty() && "Lookup table should not be built yet");
+  buildReexportClosure();
   for (auto *api : api()) {
     LookupMapBuilder builder(*this, *api);
     api->visit(builder);
   }
 
-  // sort the global entries.
+  // sort the global entries. Every entry is sorted independently.
+  std::vector<GlobalMapType::mapped_type *> globals;
+  globals.reserve(globalMap.size());
   for (auto &entry : globalMap)
-    llvm::sort(entry.second);
+    globals.emplace_back(&entry.second);
+  parallelForEachIndex(globals.size(), builder->getNumThreads(),
+                       [&](size_t i) { llvm::sort(*globals[i]); });
 }
 
 bool SDKDB::shouldDiagnoseProject(StringRef projectName) const {
   return !llvm::is_contained(builder->getProjectWithError(), projectName);
 }
 
+void SDKDB::buildReexportClosure() {
+  reexportClosure.clear();
+  publiclyReexported.clear();
+
+  // The closure of a library is the union of its direct reexporters and their
+  // closures. Memoize it per library so every edge is only followed once.
+  std::function<const StringSet<> &(StringRef)> getClosure =
+      [&](StringRef installName) -> const StringSet<> & {
+    auto [it, inserted] = reexportClosure.try_emplace(installName);
+    // StringMap entries have stable addresses, unlike its iterators.
+    auto &closure = it->second;
+    if (!inserted)
+      return closure;
+
+    StringSet<> result;
+    auto parents = reexportGraph.find(installName);
+    if (parents != reexportGraph.end()) {
+      for (const StringRef parent : parents->second) {
+        result.insert(parent);
+        for (const auto &entry : getClosure(parent))
+          result.insert(entry.getKey());
+      }
+    }
+    closure = std::move(result);
+    return closure;
+  };
+
+  for (const auto &entry : reexportGraph) {
+    const auto &closure = getClosure(entry.getKey());
+    if (any_of(closure.keys(),
+               [](StringRef parent) { return isPublicDylib(parent); }))
+      publiclyReexported.insert(entry.getKey());
+  }
+
+  hasReexportClosure = true;
+}
+
 bool SDKDB::isReexportedBy(StringRef installName,
                            StringRef reexportedBy) const {
+  if (hasReexportClosure) {
+    auto it = reexportClosure.find(installName);
+    return it != reexportClosure.end() && it->second.contains(reexportedBy);
+  }
+
   // Don't consider a library is reexported by itself.
   SmallVector<StringRef, 8> frontier = {installName};
   while (!frontier.empty()) {
@@ -1371,6 +1831,9 @@ bool SDKDB::isPubliclyExported(StringRef installName) const {
   if (isPublicDylib(installName))
     return true;
 
+  if (hasReexportClosure)
+    return publiclyReexported.contains(installName);
+
   SmallVector<StringRef, 8> frontier = {installName};
   while (!frontier.empty()) {
     for (const StringRef parent :
@@ -1458,6 +1921,48 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
     }
   }
 
+  // Libraries with the same content hash in both SDKDBs have the same records,
+  // so keys that only have entries from those libraries can't have any
+  // differences and are not diffed. Keys that also have entries from a changed
+  // library are still diffed, because APIs can move between libraries.
+  StringSet<> unchangedLibraries;
+  for (const auto &entry : baseline.contentHashes) {
+    if (getContentHash(entry.getKey()) == entry.getValue())
+      unchangedLibraries.insert(entry.getKey());
+  }
+
+  auto isUnchanged = [&](const auto &entry) {
+    return entry.getBinaryInfo() &&
+           unchangedLibraries.contains(entry.getInstallName());
+  };
+
+  auto isUnchangedKey = [&](const auto &baseMap, const auto &testMap,
+                            StringRef key) {
+    auto base = baseMap.find(key);
+    auto test = testMap.find(key);
+    return base != baseMap.end() && test != testMap.end() &&
+           isUnchanged(base->second) && isUnchanged(test->second);
+  };
+
+  // Diff the keys of each kind in shards on all the threads. The maps are only
+  // read from here on. Each shard records its diagnostics into its own buffer,
+  // and the buffers are reported in key order afterwards, so the output is the
+  // same as diffing the keys one by one.
+  auto diffInParallel = [&](const auto &keys, auto diff) {
+    // Keep the shards small, so a few expensive keys don't stall a thread.
+    constexpr size_t shardSize = 64;
+    size_t numShards = (keys.size() + shardSize - 1) / shardSize;
+    std::vector<DiagnosticBuffer> buffers(numShards);
+    parallelForEachIndex(
+        numShards, builder->getNumThreads(), [&](size_t shard) {
+          size_t end = std::min(keys.size(), (shard + 1) * shardSize);
+          for (size_t i = shard * shardSize; i < end; ++i)
+            diff(keys[i], buffers[shard]);
+        });
+    for (const auto &buffer : buffers)
+      buffer.replay(*builder);
+  };
+
   auto isKnownObjCSymbol = [&](StringRef symbolName) -> bool {
     auto [name, symbolType, _] = parseSymbol(symbolName);
     switch (symbolType) {
@@ -1479,7 +1984,15 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
   };
 
   // 1. check globals.
-  for (auto name : allKeysFromMaps(baseline.globalMap, globalMap)) {
+  auto globals = allKeysFromMaps(baseline.globalMap, globalMap);
+  llvm::erase_if(globals, [&](StringRef name) {
+    auto base = baseline.globalMap.find(name);
+    auto test = globalMap.find(name);
+    return base != baseline.globalMap.end() && test != globalMap.end() &&
+           llvm::all_of(base->second, isUnchanged) &&
+           llvm::all_of(test->second, isUnchanged);
+  });
+  diffInParallel(globals, [&](StringRef name, DiagnosticBuffer &diags) {
     // Skip diagnosing linker directives to reduce noise.
     // Special linker symbols like `$ld$install_name` or `$ld$previous` are not
     // APIs/SPIs that fall into the scope of SDKDB diffing. They provide symbol
@@ -1487,7 +2000,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
     // for the moved APIs, but there's no need to report changes of the linker
     // directives themselves.
     if (name.startswith("$ld$"))
-      continue;
+      return;
 
     // FIXME: This is only a temporary workaround to further rinsing the
     // diagnostics to show the real issues we need to investigate with
@@ -1495,13 +2008,13 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
     // allowlist all Swift symbols in SDKDB.
     // Remove this filter with rdar://109905325
     if (name.startswith("_$s"))
-      continue;
+      return;
 
     // If the global symbol is accounted for in a different classification (e.g.
     // classes or ivars), defer any potential differences to those container
     // comparisons.
     if (isKnownObjCSymbol(name))
-      continue;
+      return;
 
     auto base = baseline.globalMap.find(name);
     auto test = globalMap.find(name);
@@ -1517,11 +2030,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                               missing.getInstallName()}))
           continue;
 
-        builder->report(diag::err_sdkdb_missing_global)
+        diags.report(diag::err_sdkdb_missing_global)
             << (unsigned)missing.getRecord()->kind << name
             << missing.getInstallName() << getTargetTriple().str();
       }
-      continue;
+      return;
     }
 
     // new API.
@@ -1535,11 +2048,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                               missing.getInstallName()}))
           continue;
 
-        builder->report(diag::warn_sdkdb_new_global)
+        diags.report(diag::warn_sdkdb_new_global)
             << (unsigned)missing.getRecord()->kind << name
             << missing.getInstallName() << getTargetTriple().str();
       }
-      continue;
+      return;
     }
 
     auto isMatchingGlobalEntry = [&](const auto &baseEntry,
@@ -1565,7 +2078,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           shouldDiagnoseEntry(testEntry, *this) &&
           !isExpectedChange({ChangeType::Add, EntryType::Global, name,
                              testEntry.getInstallName()})) {
-        builder->report(diag::warn_sdkdb_new_global)
+        diags.report(diag::warn_sdkdb_new_global)
             << (unsigned)testEntry.getRecord()->kind << name
             << testEntry.getInstallName() << getTargetTriple().str();
       } else if (shouldDiagnoseEntry(baseEntry, *this)) {
@@ -1576,10 +2089,10 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         checkAPIRecord(*testEntry.getRecord(), *record, [&](StringRef error) {
           if (!isExpectedChange({ChangeType::UpdateAccess, EntryType::Global,
                                  name, baseInstallName})) {
-            builder->report(diag::err_sdkdb_global_regression)
+            diags.report(diag::err_sdkdb_global_regression)
                 << name << baseInstallName << getTargetTriple().str() << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         });
@@ -1614,7 +2127,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
             !isExpectedChange({ChangeType::Add, EntryType::Global, name,
                                testEntry.getInstallName()})) {
           // new APIs case 2.
-          builder->report(diag::warn_sdkdb_new_global)
+          diags.report(diag::warn_sdkdb_new_global)
               << (unsigned)testEntry.getRecord()->kind << name
               << testEntry.getInstallName() << getTargetTriple().str();
         }
@@ -1644,7 +2157,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
             !missingLibraries.contains(baseEntry.getInstallName()) &&
             !isExpectedChange({ChangeType::Remove, EntryType::Global, name,
                                baseEntry.getInstallName()})) {
-          builder->report(diag::err_sdkdb_missing_global)
+          diags.report(diag::err_sdkdb_missing_global)
               << (unsigned)baseEntry.getRecord()->kind << name
               << baseEntry.getInstallName() << getTargetTriple().str();
         }
@@ -1673,13 +2186,13 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                  !isExpectedChange({ChangeType::Add, EntryType::Global, name,
                                     testEntry.getInstallName()})) {
         // new API.
-        builder->report(diag::warn_sdkdb_new_global)
+        diags.report(diag::warn_sdkdb_new_global)
             << (unsigned)testEntry.getRecord()->kind << name
             << testEntry.getInstallName() << getTargetTriple().str();
       }
       ++testIdx;
     }
-  }
+  });
 
   auto isMovedLibrary = [&](const auto &base, const auto &test) -> bool {
     // If the base symbol comes from a missing library *and* the test symbol
@@ -1698,7 +2211,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
   };
 
   // 2. check objc classes.
-  for (auto name : allKeysFromMaps(baseline.interfaceMap, interfaceMap)) {
+  auto interfaces = allKeysFromMaps(baseline.interfaceMap, interfaceMap);
+  llvm::erase_if(interfaces, [&](StringRef name) {
+    return isUnchangedKey(baseline.interfaceMap, interfaceMap, name);
+  });
+  diffInParallel(interfaces, [&](StringRef name, DiagnosticBuffer &diags) {
     auto base = baseline.interfaceMap.find(name);
     auto test = interfaceMap.find(name);
     // regression.
@@ -1710,11 +2227,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           missingLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Remove, EntryType::Interface, name,
                             missing.getInstallName()}))
-        continue;
+        return;
 
-      builder->report(diag::err_sdkdb_missing_objc)
+      diags.report(diag::err_sdkdb_missing_objc)
           << 0 << name << missing.getInstallName() << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API.
@@ -1726,30 +2243,30 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           newLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Add, EntryType::Interface, name,
                             missing.getInstallName()}))
-        continue;
-      builder->report(diag::warn_sdkdb_new_objc)
+        return;
+      diags.report(diag::warn_sdkdb_new_objc)
           << 0 << name << missing.getInstallName() << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // We have a matching pair of Objective-C classes in base and test.
 
     if (isMovedLibrary(base->second, test->second))
-      continue;
+      return;
 
     // new API case 2. Promoted from existing class.
     if (base->second.getRecord()->access != APIAccess::Public &&
         shouldDiagnoseEntry(test->second, *this) &&
         !isExpectedChange({ChangeType::Add, EntryType::Interface, name,
                            test->second.getInstallName()})) {
-      builder->report(diag::warn_sdkdb_new_objc)
+      diags.report(diag::warn_sdkdb_new_objc)
           << 0 << name << test->second.getInstallName()
           << getTargetTriple().str();
-      continue;
+      return;
     }
 
     if (!shouldDiagnoseEntry(base->second, *this))
-      continue;
+      return;
 
     auto baseInstallName = base->second.getInstallName();
     auto testInstallName = test->second.getInstallName();
@@ -1758,11 +2275,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         [&](StringRef error) {
           if (!isExpectedChange({ChangeType::UpdateAccess, EntryType::Interface,
                                  name, baseInstallName})) {
-            builder->report(diag::err_sdkdb_objc_container_regression)
+            diags.report(diag::err_sdkdb_objc_container_regression)
                 << 0 << name << baseInstallName << getTargetTriple().str()
                 << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -1780,7 +2297,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name}))
-            builder->report(diag::warn_sdkdb_new_objc_method)
+            diags.report(diag::warn_sdkdb_new_objc_method)
                 << method->name << method->isInstanceMethod << 0 << name
                 << baseInstallName << getTargetTriple().str();
         },
@@ -1790,12 +2307,12 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 0 << name
                 << baseInstallName << getTargetTriple().str()
                 << "selector is missing";
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -1805,19 +2322,30 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 0 << name
                 << baseInstallName << getTargetTriple().str() << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         });
-  }
+  });
 
   // 3. check objc categories.
-  for (auto names :
-       allKeyPairsFromNestedMaps(baseline.categoryMap, categoryMap)) {
+  auto categories =
+      allKeyPairsFromNestedMaps(baseline.categoryMap, categoryMap);
+  llvm::erase_if(categories,
+                 [&](const std::pair<StringRef, StringRef> &names) {
+                   auto base = baseline.categoryMap.find(names.first);
+                   auto test = categoryMap.find(names.first);
+                   return base != baseline.categoryMap.end() &&
+                          test != categoryMap.end() &&
+                          isUnchangedKey(base->second, test->second,
+                                         names.second);
+                 });
+  diffInParallel(categories, [&](const std::pair<StringRef, StringRef> &names,
+                                 DiagnosticBuffer &diags) {
     auto findCategory = [&](const SDKDB::CategoryMapType &map)
         -> std::optional<MapEntry<ObjCCategoryRecord *>> {
       auto clsRes = map.find(names.first);
@@ -1845,12 +2373,12 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           missingLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Remove, EntryType::Category,
                             categoryName, missing.getInstallName()}))
-        continue;
+        return;
 
-      builder->report(diag::err_sdkdb_missing_objc)
+      diags.report(diag::err_sdkdb_missing_objc)
           << 1 << categoryName << missing.getInstallName()
           << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API.
@@ -1862,31 +2390,31 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           newLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Add, EntryType::Category, categoryName,
                             missing.getInstallName()}))
-        continue;
-      builder->report(diag::warn_sdkdb_new_objc)
+        return;
+      diags.report(diag::warn_sdkdb_new_objc)
           << 1 << categoryName << missing.getInstallName()
           << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // We have a matching pair of Objective-C categories in base and test.
 
     if (isMovedLibrary(*base, *test))
-      continue;
+      return;
 
     // new API case 2. Promoted from existing categories.
     if (base->getRecord()->access != APIAccess::Public &&
         shouldDiagnoseEntry(*test, *this) &&
         !isExpectedChange({ChangeType::Add, EntryType::Category, categoryName,
                            test->getInstallName()})) {
-      builder->report(diag::warn_sdkdb_new_objc)
+      diags.report(diag::warn_sdkdb_new_objc)
           << 1 << categoryName << test->getInstallName()
           << getTargetTriple().str();
-      continue;
+      return;
     }
 
     if (!shouldDiagnoseEntry(*base, *this))
-      continue;
+      return;
 
     auto baseInstallName = base->getInstallName();
     auto testInstallName = test->getInstallName();
@@ -1895,11 +2423,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         [&](StringRef error) {
           if (!isExpectedChange({ChangeType::UpdateAccess, EntryType::Category,
                                  categoryName, baseInstallName})) {
-            builder->report(diag::err_sdkdb_objc_container_regression)
+            diags.report(diag::err_sdkdb_objc_container_regression)
                 << 1 << categoryName << baseInstallName
                 << getTargetTriple().str() << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -1917,7 +2445,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, categoryName}))
-            builder->report(diag::warn_sdkdb_new_objc_method)
+            diags.report(diag::warn_sdkdb_new_objc_method)
                 << method->name << method->isInstanceMethod << 1 << categoryName
                 << baseInstallName << getTargetTriple().str();
         },
@@ -1927,12 +2455,12 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                    method->isInstanceMethod ? EntryType::InstanceMethod
                                             : EntryType::ClassMethod,
                    method->name, baseInstallName, categoryName})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 1 << categoryName
                 << baseInstallName << getTargetTriple().str()
                 << "selector is missing";
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -1942,18 +2470,22 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                    method->isInstanceMethod ? EntryType::InstanceMethod
                                             : EntryType::ClassMethod,
                    method->name, baseInstallName, categoryName})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 1 << categoryName
                 << baseInstallName << getTargetTriple().str() << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         });
-  }
+  });
 
   // 4. check objc protocols.
-  for (auto name : allKeysFromMaps(baseline.protocolMap, protocolMap)) {
+  auto protocols = allKeysFromMaps(baseline.protocolMap, protocolMap);
+  llvm::erase_if(protocols, [&](StringRef name) {
+    return isUnchangedKey(baseline.protocolMap, protocolMap, name);
+  });
+  diffInParallel(protocols, [&](StringRef name, DiagnosticBuffer &diags) {
     auto base = baseline.protocolMap.find(name);
     auto test = protocolMap.find(name);
     // regression.
@@ -1965,11 +2497,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           missingLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Remove, EntryType::Protocol, name,
                             missing.getInstallName()}))
-        continue;
+        return;
 
-      builder->report(diag::err_sdkdb_missing_objc)
+      diags.report(diag::err_sdkdb_missing_objc)
           << 2 << name << missing.getInstallName() << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API.
@@ -1981,31 +2513,31 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
           newLibraries.contains(missing.getInstallName()) ||
           isExpectedChange({ChangeType::Add, EntryType::Protocol, name,
                             missing.getInstallName()}))
-        continue;
+        return;
 
-      builder->report(diag::warn_sdkdb_new_objc)
+      diags.report(diag::warn_sdkdb_new_objc)
           << 2 << name << missing.getInstallName() << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // We have a matching pair of Objective-C protocols in base and test.
 
     if (isMovedLibrary(base->second, test->second))
-      continue;
+      return;
 
     // new API case 2. Promoted from existing protocol.
     if (base->second.getRecord()->access != APIAccess::Public &&
         shouldDiagnoseEntry(test->second, *this) &&
         !isExpectedChange({ChangeType::Add, EntryType::Protocol, name,
                            test->second.getInstallName()})) {
-      builder->report(diag::warn_sdkdb_new_objc)
+      diags.report(diag::warn_sdkdb_new_objc)
           << 2 << name << test->second.getInstallName()
           << getTargetTriple().str();
-      continue;
+      return;
     }
 
     if (!shouldDiagnoseEntry(base->second, *this))
-      continue;
+      return;
 
     auto baseInstallName = base->second.getInstallName();
     auto testInstallName = test->second.getInstallName();
@@ -2015,11 +2547,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         [&](StringRef error) {
           if (!isExpectedChange({ChangeType::UpdateAccess, EntryType::Protocol,
                                  name, baseInstallName})) {
-            builder->report(diag::err_sdkdb_objc_container_regression)
+            diags.report(diag::err_sdkdb_objc_container_regression)
                 << 2 << name << baseInstallName << getTargetTriple().str()
                 << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -2037,7 +2569,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name}))
-            builder->report(diag::warn_sdkdb_new_objc_method)
+            diags.report(diag::warn_sdkdb_new_objc_method)
                 << method->name << method->isInstanceMethod << 2 << name
                 << baseInstallName << getTargetTriple().str();
         },
@@ -2047,12 +2579,12 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 2 << name
                 << baseInstallName << getTargetTriple().str()
                 << "selector is missing";
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         },
@@ -2062,22 +2594,26 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
                                      ? EntryType::InstanceMethod
                                      : EntryType::ClassMethod,
                                  method->name, baseInstallName, name})) {
-            builder->report(diag::err_sdkdb_objc_method_regression)
+            diags.report(diag::err_sdkdb_objc_method_regression)
                 << method->name << method->isInstanceMethod << 2 << name
                 << baseInstallName << getTargetTriple().str() << error;
             if (baseInstallName != testInstallName)
-              builder->report(diag::note_sdkdb_moved_symbol)
+              diags.report(diag::note_sdkdb_moved_symbol)
                   << baseInstallName << testInstallName;
           }
         });
-  }
+  });
 
   // Skip comparing enums and typedefs.
   if (!builder->diagnoseFrontendAPI())
     return;
 
   // 5. check enums.
-  for (auto name : allKeysFromMaps(baseline.enumMap, enumMap)) {
+  auto enums = allKeysFromMaps(baseline.enumMap, enumMap);
+  llvm::erase_if(enums, [&](StringRef name) {
+    return isUnchangedKey(baseline.enumMap, enumMap, name);
+  });
+  diffInParallel(enums, [&](StringRef name, DiagnosticBuffer &diags) {
     auto base = baseline.enumMap.find(name);
     auto test = enumMap.find(name);
     // regression.
@@ -2086,11 +2622,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
       // ignore the private APIs.
       auto missing = base->second;
       if (missing.getRecord()->access != APIAccess::Public)
-        continue;
+        return;
 
-      builder->report(diag::err_sdkdb_missing_frontend_api)
+      diags.report(diag::err_sdkdb_missing_frontend_api)
           << 0 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API.
@@ -2098,24 +2634,24 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
       assert(test != enumMap.end() && "test version should exist");
       auto missing = test->second;
       if (missing.getRecord()->access != APIAccess::Public)
-        continue;
-      builder->report(diag::warn_sdkdb_new_frontend_api)
+        return;
+      diags.report(diag::warn_sdkdb_new_frontend_api)
           << 0 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API case 2. Promoted from existing enums.
     if (base->second.getRecord()->access != APIAccess::Public &&
         test->second.getRecord()->access == APIAccess::Public) {
-      builder->report(diag::warn_sdkdb_new_frontend_api)
+      diags.report(diag::warn_sdkdb_new_frontend_api)
           << 0 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // check all the fields.
     checkAPIRecord(*test->second.getRecord(), *base->second.getRecord(),
                    [&](StringRef error) {
-                     builder->report(diag::err_sdkdb_frontend_api_regression)
+                     diags.report(diag::err_sdkdb_frontend_api_regression)
                          << 0 << name << getTargetTriple().str() << error;
                    });
 
@@ -2139,7 +2675,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         if (missing->access != APIAccess::Public)
           continue;
 
-        builder->report(diag::err_sdkdb_missing_frontend_api)
+        diags.report(diag::err_sdkdb_missing_frontend_api)
             << 1 << c << getTargetTriple().str();
         continue;
       }
@@ -2150,7 +2686,7 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
         auto *missing = *tc;
         if (missing->access != APIAccess::Public)
           continue;
-        builder->report(diag::warn_sdkdb_new_frontend_api)
+        diags.report(diag::warn_sdkdb_new_frontend_api)
             << 1 << c << getTargetTriple().str();
         continue;
       }
@@ -2158,20 +2694,24 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
       // new API case 2.
       if ((*bc)->access != APIAccess::Public &&
           (*tc)->access == APIAccess::Public) {
-        builder->report(diag::warn_sdkdb_new_frontend_api)
+        diags.report(diag::warn_sdkdb_new_frontend_api)
             << 1 << c << getTargetTriple().str();
         continue;
       }
 
       checkAPIRecord(**tc, **bc, [&](StringRef error) {
-        builder->report(diag::err_sdkdb_frontend_api_regression)
+        diags.report(diag::err_sdkdb_frontend_api_regression)
             << 2 << c << getTargetTriple().str() << error;
       });
     }
-  }
+  });
 
   // 6. check typedef.
-  for (auto name : allKeysFromMaps(baseline.typedefMap, typedefMap)) {
+  auto typedefs = allKeysFromMaps(baseline.typedefMap, typedefMap);
+  llvm::erase_if(typedefs, [&](StringRef name) {
+    return isUnchangedKey(baseline.typedefMap, typedefMap, name);
+  });
+  diffInParallel(typedefs, [&](StringRef name, DiagnosticBuffer &diags) {
     auto base = baseline.typedefMap.find(name);
     auto test = typedefMap.find(name);
     // regression.
@@ -2180,11 +2720,11 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
       // ignore the private APIs.
       auto missing = base->second;
       if (missing.getRecord()->access != APIAccess::Public)
-        continue;
+        return;
 
-      builder->report(diag::err_sdkdb_missing_frontend_api)
+      diags.report(diag::err_sdkdb_missing_frontend_api)
           << 2 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API.
@@ -2192,27 +2732,27 @@ void SDKDB::diagnoseDifferences(const SDKDB &baseline) const {
       assert(test != typedefMap.end() && "test version should exist");
       auto missing = test->second;
       if (missing.getRecord()->access != APIAccess::Public)
-        continue;
-      builder->report(diag::warn_sdkdb_new_frontend_api)
+        return;
+      diags.report(diag::warn_sdkdb_new_frontend_api)
           << 2 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // new API case 2.
     if (base->second.getRecord()->access != APIAccess::Public &&
         test->second.getRecord()->access == APIAccess::Public) {
-      builder->report(diag::warn_sdkdb_new_frontend_api)
+      diags.report(diag::warn_sdkdb_new_frontend_api)
           << 2 << name << getTargetTriple().str();
-      continue;
+      return;
     }
 
     // check all the fields.
     checkAPIRecord(*test->second.getRecord(), *base->second.getRecord(),
                    [&](StringRef error) {
-                     builder->report(diag::err_sdkdb_frontend_api_regression)
+                     diags.report(diag::err_sdkdb_frontend_api_regression)
                          << 2 << name << getTargetTriple().str() << error;
                    });
-  }
+  });
 }
 
 void SDKDBBuilder::buildLookupTables() {
@@ -27,7 +27,14 @@ const unsigned char SDKDB_SIGNATURE[] = {'S', 'D', 'K', 0xDB}; // NOLINT
 const uint16_t VERSION_MAJOR = 1; // NOLINT
 
 /// Binary store minor version number.
-const uint16_t VERSION_MINOR = 0; // NOLINT
+///
+/// Version 1 adds the optional symbol table block. Binary stores without it
+/// are still written as VERSION_MINOR_NO_SYMBOL_TABLE so that older readers,
+/// which reject newer minor versions, can load them.
+const uint16_t VERSION_MINOR = 1; // NOLINT
+
+/// Binary store minor version number for files without a symbol table.
+const uint16_t VERSION_MINOR_NO_SYMBOL_TABLE = 0; // NOLINT
 
 /// \brief The blocks that can appear in a binary store.
 ///
@@ -112,6 +119,12 @@ enum BlockID {
   ///
   /// \sa typdef_block
   TYPEDEF_BLOCK_ID,
+
+  /// The symbol lookup table block, which maps exported symbols to the
+  /// libraries that export them. This block is optional.
+  ///
+  /// \sa symbol_table_block
+  SYMBOL_TABLE_BLOCK_ID,
 };
 
 // clang-format off
@@ -181,6 +194,9 @@ enum {
 
   /// Project name.
   PROJECT_NAME = 11,
+
+  /// Content hash of the library, low and high 32 bits.
+  CONTENT_HASH = 12,
 };
 } // end namespace api_block
 
@@ -385,6 +401,18 @@ enum {
 };
 } // end namespace typedef_block
 
+namespace symbol_table_block {
+// These IDs must \em not be renumbered or reordered without incrementing
+// VERSION_MAJOR.
+enum {
+  // Target Triple for the lookup table.
+  TARGET_TRIPLE = 1,
+
+  // OnDiskHashTable.
+  LOOKUP_TABLE = 2,
+};
+} // end namespace symbol_table_block
+
 // clang-format on
 
 TAPI_NAMESPACE_INTERNAL_END
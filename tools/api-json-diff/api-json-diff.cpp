@@ -68,14 +68,33 @@ Expected<std::unique_ptr<json::Object>> loadJSON(const StringRef filePath) {
 
 using Partials = std::pair<const PartialSDKDB, const PartialSDKDB>;
 Expected<std::unique_ptr<Partials>> loadPartialSDKDB(const StringRef filePath) {
-  auto jsonOrErr = loadJSON(filePath);
+  auto bufferOrErr = loadFile(filePath);
+  if (!bufferOrErr)
+    return bufferOrErr.takeError();
+
+  // Partial SDKDBs in the binary format are decoded once for both sides.
+  auto buffer = (*bufferOrErr)->getBuffer();
+  if (PartialSDKDB::isBinaryFormat(buffer)) {
+    PartialSDKDB publicPartial;
+    PartialSDKDB privatePartial;
+    if (auto err = PartialSDKDB::createAPIsFromBinary(buffer, &publicPartial,
+                                                      &privatePartial))
+      return std::move(err);
+    return std::make_unique<Partials>(
+        std::make_pair(std::move(publicPartial), std::move(privatePartial)));
+  }
+
+  auto jsonOrErr = json::parse(buffer);
   if (!jsonOrErr)
     return jsonOrErr.takeError();
+  auto *root = jsonOrErr->getAsObject();
+  if (!root)
+    return make_error<APIJSONError>("API is not a JSON Object");
 
-  auto publicPartial = PartialSDKDB::createPublicAPIsFromJSON(**jsonOrErr);
+  auto publicPartial = PartialSDKDB::createPublicAPIsFromJSON(*root);
   if (!publicPartial)
     return publicPartial.takeError();
-  auto privatePartial = PartialSDKDB::createPrivateAPIsFromJSON(**jsonOrErr);
+  auto privatePartial = PartialSDKDB::createPrivateAPIsFromJSON(*root);
   if (!privatePartial)
     return privatePartial.takeError();
 
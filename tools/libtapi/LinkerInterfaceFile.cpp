@@ -195,17 +195,28 @@ LinkerInterfaceFile::getSupportedFileExtensions() noexcept {
   return {".tbd"};
 }
 
+/// \brief Return the registry used to read text-based stub files.
+///
+/// The readers are stateless, so a single registry is set up on first use and
+/// shared by all callers and threads.
+static const Registry &getTextFileRegistry() {
+  static const Registry registry = []() {
+    Registry registry;
+    registry.addYAMLReaders();
+    registry.addJSONReaders();
+    registry.addDiagnosticReader();
+    return registry;
+  }();
+  return registry;
+}
+
 /// \brief Load and parse the provided TBD file in the buffer and return on
 ///        success the interface file.
 static Expected<std::unique_ptr<const InterfaceFile>>
 loadFile(std::unique_ptr<MemoryBuffer> buffer,
          ReadFlags readFlags = ReadFlags::Symbols) {
-  Registry registry;
-  registry.addYAMLReaders();
-  registry.addJSONReaders();
-  registry.addDiagnosticReader();
-
-  auto textFile = registry.readTextFile(std::move(buffer), readFlags);
+  auto textFile =
+      getTextFileRegistry().readTextFile(std::move(buffer), readFlags);
   if (!textFile)
     return textFile.takeError();
 
@@ -218,13 +229,9 @@ loadFile(std::unique_ptr<MemoryBuffer> buffer,
 bool LinkerInterfaceFile::isSupported(const std::string &path,
                                       const uint8_t *data,
                                       size_t size) noexcept {
-  Registry registry;
-  registry.addYAMLReaders();
-  registry.addJSONReaders();
-  registry.addDiagnosticReader();
   auto memBuffer = MemoryBufferRef(
       StringRef(reinterpret_cast<const char *>(data), size), path);
-  return registry.canRead(memBuffer);
+  return getTextFileRegistry().canRead(memBuffer);
 }
 
 bool LinkerInterfaceFile::shouldPreferTextBasedStubFile(
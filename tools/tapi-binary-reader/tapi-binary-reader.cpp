@@ -93,6 +93,8 @@ int main(int argc, const char *argv[]) {
 
   MachOParseOption option;
   option.arches = archToParse;
+  // Only a single binary is read, so its slices can use all cores.
+  option.numThreads = 0;
   auto results = readMachOFile((*buffer)->getMemBufferRef(), option);
 
   if (!results) {
@@ -16,6 +16,7 @@
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 
 #include "tapi/Core/FileSystem.h"
+#include "tapi/Core/Utils.h"
 #include "tapi/tapi.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -30,6 +32,9 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 using namespace llvm;
 
@@ -55,6 +60,31 @@ static cl::opt<unsigned> num("n", cl::desc("number of iterations"),
                              cl::value_desc("1"), cl::init(1),
                              cl::cat(tapiRunCategory));
 
+static cl::opt<unsigned>
+    numThreads("j", cl::desc("number of threads loading files (0 uses all "
+                             "available cores)"),
+               cl::value_desc("1"), cl::init(1), cl::cat(tapiRunCategory));
+
+static cl::opt<std::string>
+    jsonReport("json-report", cl::desc("Write a JSON report to the file"),
+               cl::value_desc("filename"), cl::cat(tapiRunCategory));
+
+namespace {
+struct Load {
+  unsigned fileIndex;
+  unsigned archIndex;
+  double seconds = 0.0;
+};
+} // end anonymous namespace
+
+// Nearest-rank percentile of the sorted latencies.
+static double getPercentile(ArrayRef<double> sorted, unsigned percentile) {
+  if (sorted.empty())
+    return 0.0;
+  size_t rank = (sorted.size() * percentile + 99) / 100;
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
 static std::tuple<cpu_type_t, cpu_subtype_t, StringRef>
 parseArchKind(StringRef arch) {
   auto cpuType = StringSwitch<cpu_type_t>(arch)
@@ -184,7 +214,11 @@ int main(int argc, const char *argv[]) {
 
   auto currentBenchmarkName = sys::path::stem(path);
 
+  // Collect the files first, so the loads can be handed out from a single
+  // work queue. The traversal is part of the measured time, like it was
+  // before the loads were queued.
   auto start = TimeRecord::getCurrentTime(/*start=*/true);
+  std::vector<std::string> inputs;
   std::error_code ec;
   for (sys::fs::recursive_directory_iterator i(path, ec), ie; i != ie;
        i.increment(ec)) {
@@ -210,29 +244,114 @@ int main(int argc, const char *argv[]) {
     if (sys::path::extension(i->path()) != ".tbd")
       continue;
 
-    for (auto &arch : archSet) {
-      for (unsigned j = 0; j < num; ++j) {
-        std::string errorMessage;
+    inputs.emplace_back(i->path());
+  }
+
+  std::vector<Load> loads;
+  for (unsigned fileIndex = 0; fileIndex < inputs.size(); ++fileIndex)
+    for (unsigned archIndex = 0; archIndex < archSet.size(); ++archIndex)
+      for (unsigned j = 0; j < num; ++j)
+        loads.push_back({fileIndex, archIndex});
+
+  // Stop handing out loads after the first failure. With a single thread
+  // this stops at the failing input, like the serial loop did.
+  std::mutex errorLock;
+  std::string errorMessage;
+  std::atomic<bool> hasError{false};
+  tapi::internal::parallelForEachIndex(
+      loads.size(), numThreads, [&](size_t index) {
+        if (hasError)
+          return;
+        auto &load = loads[index];
+        auto &arch = archSet[load.archIndex];
+        std::string error;
+        auto begin = std::chrono::steady_clock::now();
         auto file = std::unique_ptr<tapi::LinkerInterfaceFile>(
             tapi::LinkerInterfaceFile::create(
-                i->path(), std::get<0>(arch), std::get<1>(arch),
-                tapi::ParsingFlags::None, packedVersion, errorMessage));
+                inputs[load.fileIndex], std::get<0>(arch), std::get<1>(arch),
+                tapi::ParsingFlags::None, packedVersion, error));
+        load.seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - begin)
+                           .count();
         if (file == nullptr) {
-          errs() << "error: " << errorMessage << "\n";
-          return 1;
+          std::lock_guard<std::mutex> lock(errorLock);
+          if (!hasError)
+            errorMessage = error;
+          hasError = true;
         }
-      }
-    }
-  }
-
+      });
   auto time = TimeRecord::getCurrentTime(/*start=*/false);
   time -= start;
+
+  if (hasError) {
+    errs() << "error: " << errorMessage << "\n";
+    return 1;
+  }
+
+  std::vector<double> latencies;
+  for (const auto &load : loads)
+    latencies.push_back(load.seconds);
+  llvm::sort(latencies);
+  double p50 = getPercentile(latencies, 50);
+  double p90 = getPercentile(latencies, 90);
+  double p99 = getPercentile(latencies, 99);
+  double max = latencies.empty() ? 0.0 : latencies.back();
+
   file << "nts." << currentBenchmarkName << ".user "
        << format("%0.6f", time.getUserTime()) << "\n";
   file << "nts." << currentBenchmarkName << ".sys "
        << format("%0.6f", time.getSystemTime()) << "\n";
   file << "nts." << currentBenchmarkName << ".wall "
        << format("%0.6f", time.getWallTime()) << "\n";
+  file << "nts." << currentBenchmarkName << ".p50 " << format("%0.6f", p50)
+       << "\n";
+  file << "nts." << currentBenchmarkName << ".p90 " << format("%0.6f", p90)
+       << "\n";
+  file << "nts." << currentBenchmarkName << ".p99 " << format("%0.6f", p99)
+       << "\n";
+  file << "nts." << currentBenchmarkName << ".max " << format("%0.6f", max)
+       << "\n";
+
+  if (!jsonReport.empty()) {
+    std::error_code ec3;
+    raw_fd_ostream report(jsonReport, ec3, sys::fs::OpenFlags::OF_Text);
+    if (ec3) {
+      errs() << "error: " << ec3.message() << " (" << jsonReport << ")\n";
+      return 1;
+    }
+
+    json::OStream json(report, 2);
+    json.object([&]() {
+      json.attribute("benchmark", currentBenchmarkName);
+      json.attribute("threads", (int64_t)numThreads);
+      json.attribute("iterations", (int64_t)num);
+      json.attribute("loads", (int64_t)loads.size());
+      json.attribute("user", time.getUserTime());
+      json.attribute("sys", time.getSystemTime());
+      json.attribute("wall", time.getWallTime());
+      json.attributeObject("latency", [&]() {
+        json.attribute("p50", p50);
+        json.attribute("p90", p90);
+        json.attribute("p99", p99);
+        json.attribute("max", max);
+      });
+      // Per file and architecture, the slowest of all iterations.
+      json.attributeArray("files", [&]() {
+        for (size_t i = 0; i < loads.size(); i += num) {
+          double slowest = 0.0;
+          for (size_t j = i; j < i + num; ++j)
+            slowest = std::max(slowest, loads[j].seconds);
+          json.object([&]() {
+            json.attribute("path", inputs[loads[i].fileIndex]);
+            json.attribute("arch",
+                           std::get<2>(archSet[loads[i].archIndex]));
+            json.attribute("max", slowest);
+          });
+        }
+      });
+    });
+    report << "\n";
+  }
 
   file.flush();
   if (ec2) {
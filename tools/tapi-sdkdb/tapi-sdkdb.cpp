@@ -44,6 +44,7 @@ enum OutputKind {
   ProjectWithError,
   ExtractTargets,
   APILoad,
+  SymbolLookup,
   Compare,
 };
 
@@ -56,6 +57,8 @@ static cl::opt<OutputKind> outputKind(
                           "perform fast check path exists for target"),
                clEnumValN(APILoad, "load-api",
                           "load all the APIs (include re-exports)"),
+               clEnumValN(SymbolLookup, "lookup-symbol",
+                          "print the libraries that export a symbol"),
                clEnumValN(ProjectWithError, "error-projects",
                           "print all projects with errors"),
                clEnumValN(ExtractTargets, "extract",
@@ -109,6 +112,12 @@ static cl::opt<std::string>
                              "for comparing SDKDB\n"),
                     cl::cat(compareCategory));
 
+static cl::opt<unsigned>
+    numThreads("j",
+               cl::desc("Number of threads used to compare SDKDBs (0 uses all "
+                        "available cores)"),
+               cl::init(0), cl::cat(compareCategory));
+
 static cl::opt<std::string> sdkdbFile(cl::Positional, cl::desc("<SDKDB>"),
                                       cl::Required, cl::cat(tapiCategory));
 
@@ -125,6 +134,11 @@ static cl::opt<bool> simplifiedSDKDB("simplified",
                                      cl::desc("Output simplified SDKDB"),
                                      cl::cat(extractCategory));
 
+static cl::opt<bool>
+    emitSymbolTable("symbol-table",
+                    cl::desc("Add a symbol lookup table to SDKDB output"),
+                    cl::cat(extractCategory));
+
 int main(int argc, const char *argv[]) {
   // Standard set up, so program fails gracefully.
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -163,6 +177,8 @@ int main(int argc, const char *argv[]) {
       outs() << "SDKDB contains only public APIs\n";
     if (reader->noObjCMetadata())
       outs() << "SDKDB has no objc metadata\n";
+    if (reader->hasSymbolTable())
+      outs() << "SDKDB has a symbol lookup table\n";
     break;
   case AvailableTargets:
     outs() << "Available Targets:\n";
@@ -211,6 +227,39 @@ int main(int argc, const char *argv[]) {
     builder.serialize(outs(), /*compact*/ false);
     break;
   }
+  case SymbolLookup: {
+    if (sdkdbTargets.size() != 1 || apiNames.size() != 1) {
+      errs() << "lookup-symbol option requires one -target and one -name "
+                "option\n";
+      return 1;
+    }
+    Triple target(sdkdbTargets.front());
+    auto entries = reader->lookupSymbol(target, apiNames.front());
+    if (!entries) {
+      errs() << "cannot read symbol table: " << toString(entries.takeError())
+             << "\n";
+      return 1;
+    }
+    if (entries->empty()) {
+      outs() << "Symbol is not exported: " << apiNames.front() << " ("
+             << target.str() << ")\n";
+      return 1;
+    }
+    for (const auto &entry : *entries) {
+      outs() << entry.installName;
+      const auto &availability = entry.availability;
+      if (!availability._introduced.empty())
+        outs() << " introduced=" << availability._introduced;
+      if (!availability._obsoleted.empty())
+        outs() << " obsoleted=" << availability._obsoleted;
+      if (availability._unavailable)
+        outs() << " unavailable";
+      if (availability._isSPIAvailable)
+        outs() << " spi";
+      outs() << "\n";
+    }
+    break;
+  }
   case ExtractTargets: {
     if (sdkdbTargets.size() < 1) {
       errs() << "extract option requires one or more -target option\n";
@@ -237,6 +286,8 @@ int main(int argc, const char *argv[]) {
       builder.setRemoveObjCMetadata();
     if (removeBundles)
       builder.setRemoveBundles();
+    if (emitSymbolTable)
+      builder.setEmitSymbolTable();
     std::error_code ec;
     raw_fd_ostream fs(outputFile, ec);
     if (ec) {
@@ -329,6 +380,8 @@ int main(int argc, const char *argv[]) {
       }
     }
 
+    builder.setNumThreads(numThreads);
+    baseline.setNumThreads(numThreads);
     builder.setNoNewAPI(noNewAPI);
     builder.setReportNewAPIasError(newAPIAsError);
     builder.setDiagnoseFrontendAPI(compareFrontendAPI);